@@ -0,0 +1,20 @@
+#version 330
+
+// From Vertex Shader
+in vec2 texcoord;
+in vec3 vcolor;
+in float opacity;
+
+// Application data
+uniform sampler2D digits;
+
+// Output color
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	// digits come from the font's distance field atlas, 0.5 is the glyph edge
+	float distance = texture(digits, texcoord).r;
+	float smoothing = fwidth(distance) * 0.5;
+	color = vec4(vcolor, opacity * smoothstep(0.5 - smoothing, 0.5 + smoothing, distance));
+}
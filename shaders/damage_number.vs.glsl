@@ -0,0 +1,47 @@
+#version 330
+
+// Input attributes (unit quad centred on the origin)
+in vec3 in_position;
+
+// per digit: spawn position (xy), spawn time (z), digit (w)
+in vec4 in_number;
+// per digit: offset from the start of the number (x), colour (yzw)
+in vec4 in_glyph;
+
+out vec2 texcoord;
+out vec3 vcolor;
+out float opacity;
+
+// Application data
+uniform mat3 projection;
+uniform float time;
+uniform float lifetime;
+// per digit: rect in the atlas (u, v, width, height) and glyph box in pixels (size xy, bearing zw)
+uniform vec4 digit_uv[10];
+uniform vec4 digit_box[10];
+
+// how far a number floats up over its life
+const float RISE = 30.0;
+
+void main()
+{
+	int digit = int(in_number.w);
+	vec4 uv = digit_uv[digit];
+	vec4 box = digit_box[digit];
+
+	// 1 when spawned, 0 once expired, expired digits left in the buffer collapse to nothing
+	float remaining = clamp(1.0 - (time - in_number.z) / lifetime, 0.0, 1.0);
+	float scale = sin(remaining * 3.14159265);
+	opacity = remaining;
+	vcolor = in_glyph.yzw;
+
+	// glyph layout in font space (y up, origin on the baseline at the start of the number)
+	vec2 corner = in_position.xy + 0.5;
+	vec2 glyph = (vec2(in_glyph.x + box.z, box.w - box.y) + corner * box.xy) * scale;
+	texcoord = uv.xy + vec2(corner.x, 1.0 - corner.y) * uv.zw;
+
+	// the world has y going down
+	vec2 world = in_number.xy + vec2(glyph.x, -glyph.y - RISE * (1.0 - remaining));
+	vec3 pos = projection * vec3(world, 1.0);
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
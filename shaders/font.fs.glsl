@@ -9,6 +9,10 @@ uniform float opacity;
 
 void main()
 {
-	vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-	color = vec4(textColor, opacity) * sampled;
+	// the atlas holds distance fields, 0.5 is the glyph edge
+	// smoothing over one screen pixel's worth of distance keeps the edge sharp at any scale
+	float distance = texture(text, TexCoords).r;
+	float smoothing = fwidth(distance) * 0.5;
+	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+	color = vec4(textColor, opacity * coverage);
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 330
+
+// Input attributes (unit quad centred on the origin)
+in vec3 in_position;
+
+// per bar: centre (xy), full width (z) and how full it is (w)
+in vec4 in_bar;
+in vec3 in_bar_color;
+
+out vec3 vcolor;
+
+// Application data
+uniform mat3 projection;
+uniform float bar_height;
+
+void main()
+{
+	vcolor = in_bar_color;
+
+	// stretch the quad to the fill, keeping its left edge where the full bar starts
+	float x = ((in_position.x + 0.5) * in_bar.w - 0.5) * in_bar.z;
+	float y = in_position.y * bar_height;
+
+	vec3 pos = projection * vec3(in_bar.xy + vec2(x, y), 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
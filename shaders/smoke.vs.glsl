@@ -16,9 +16,8 @@ uniform vec2 uv_scale = vec2(1.0, 1.0);
 
 uniform float time;
 
-uniform vec2 offsets[300];
-uniform float scales[300];
-uniform float lifespans[300];
+// per particle: offset from the emitter (xy) and how far through its life it is (z)
+in vec3 in_instance;
 
 void main()
 {
@@ -26,10 +25,10 @@ void main()
 	texcoord = (in_texcoord * uv_scale) + uv_offset;
 
 
-	float x = offsets[gl_InstanceID][0];
-	float y = offsets[gl_InstanceID][1] + (0.001 * time);
+	float x = in_instance.x;
+	float y = in_instance.y + (0.001 * time);
 
-	scale = scales[gl_InstanceID];
+	scale = in_instance.z;
 
 
 	vec3 pos = projection * transform * vec3(in_position.xy + vec2(x, y), 1.0);
@@ -0,0 +1,61 @@
+// internal
+#include "ai_lod.hpp"
+
+AiLodScheduler ai_lod;
+
+// room past the edge of the screen for an enemy's sprite to still be showing
+const float ON_SCREEN_MARGIN = 100.f;
+// near is anything within one more screen in each direction
+const vec2 NEAR_HALF_EXTENT = {window_width_px * 1.5f, window_height_px * 1.5f};
+
+void AiLodScheduler::begin_frame(vec2 camera_position)
+{
+	for (int i = 0; i < ai_tier_count; i++)
+	{
+		last_counts[i] = counts[i];
+		counts[i] = 0;
+	}
+	last_updated = updated_count;
+	updated_count = 0;
+
+	camera = camera_position;
+	frame += 1;
+}
+
+AI_TIER AiLodScheduler::tier_of(vec2 position) const
+{
+	vec2 offset = abs(position - camera);
+	if (offset.x <= window_width_px / 2.f + ON_SCREEN_MARGIN && offset.y <= window_height_px / 2.f + ON_SCREEN_MARGIN)
+	{
+		return AI_TIER::ON_SCREEN;
+	}
+	if (offset.x <= NEAR_HALF_EXTENT.x && offset.y <= NEAR_HALF_EXTENT.y)
+	{
+		return AI_TIER::NEAR;
+	}
+	return AI_TIER::FAR;
+}
+
+bool AiLodScheduler::update_due(Entity entity, vec2 position)
+{
+	AI_TIER tier = tier_of(position);
+	counts[(int)tier] += 1;
+
+	unsigned int interval = 1;
+	if (tier == AI_TIER::NEAR)
+	{
+		interval = NEAR_INTERVAL;
+	}
+	else if (tier == AI_TIER::FAR)
+	{
+		interval = FAR_INTERVAL;
+	}
+
+	// an enemy coming on screen is due straight away and catches up on everything it skipped
+	if ((frame + (unsigned int)entity) % interval != 0)
+	{
+		return false;
+	}
+	updated_count += 1;
+	return true;
+}
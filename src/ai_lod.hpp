@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+
+// How often an enemy's AI runs, picked from how far it is from the camera
+enum class AI_TIER
+{
+	ON_SCREEN = 0,
+	NEAR = ON_SCREEN + 1,
+	FAR = NEAR + 1,
+	AI_TIER_COUNT = FAR + 1
+};
+const int ai_tier_count = (int)AI_TIER::AI_TIER_COUNT;
+
+// Level of detail for enemy AI
+// On-screen enemies update every frame, near ones every NEAR_INTERVAL frames and far ones every FAR_INTERVAL frames,
+// the caller keeps the time that built up in between and hands all of it to the update when it is due
+// The frame an enemy is due on is offset by its id, so the skipped updates spread evenly instead of landing on the same frame
+class AiLodScheduler
+{
+public:
+	static const int NEAR_INTERVAL = 2;
+	static const int FAR_INTERVAL = 4;
+
+	// Call once per physics step before update_due
+	void begin_frame(vec2 camera_position);
+
+	AI_TIER tier_of(vec2 position) const;
+	// Counts the entity in its tier, true if its AI should run this frame
+	bool update_due(Entity entity, vec2 position);
+
+	// Counts from the last finished step
+	int count(AI_TIER tier) const { return last_counts[(int)tier]; }
+	int updated() const { return last_updated; }
+
+private:
+	vec2 camera = {0.f, 0.f};
+	unsigned int frame = 0;
+	int counts[ai_tier_count] = {};
+	int updated_count = 0;
+	int last_counts[ai_tier_count] = {};
+	int last_updated = 0;
+};
+
+extern AiLodScheduler ai_lod;
@@ -1,34 +1,217 @@
 // internal
 #include "animation_system.hpp"
 #include "world_init.hpp"
+#include "job_system.hpp"
 
 #include <iostream>
 
+AnimationLibrary animation_library;
 
-void AnimationSystem::step(float elapsed_ms)
+AnimationLibrary::AnimationLibrary()
 {
-	auto& animation_set_registry = registry.animationSets;
+	const char *player_clip_names[player_clip_count] = {
+		"player_run_s", "player_run_f", "player_run_b",
+		"player_idle_f", "player_idle_s", "player_idle_b",
+		"player_attack_f", "player_attack_s", "player_attack_b",
+		"player_die"};
+	for (int i = 0; i < player_clip_count; i++)
+	{
+		player_clips[i] = name_id(player_clip_names[i]);
+	}
+
+	// sprite sheet each enemy type's clips are named after, several types share one
+	const char *enemy_names[enemy_type_count] = {};
+	enemy_names[(int)ENEMY_TYPES::CONTACT_DMG] = "slow";
+	enemy_names[(int)ENEMY_TYPES::CONTACT_DMG_2] = "fast";
+	enemy_names[(int)ENEMY_TYPES::RANGED] = "ranged";
+	enemy_names[(int)ENEMY_TYPES::SWARM] = "swarm";
+	enemy_names[(int)ENEMY_TYPES::SLOWING_CONTACT] = "fast";
+	enemy_names[(int)ENEMY_TYPES::RANGED_HOMING] = "ranged";
+	enemy_names[(int)ENEMY_TYPES::FINAL_BOSS] = "final_boss_";
+	enemy_names[(int)ENEMY_TYPES::DASHING] = "slow";
+	const char *enemy_clip_names[enemy_clip_count] = {"enemy_idle_f", "enemy_run_f", "enemy_attack_f", "enemy_die", "landlord"};
+	for (int type = 0; type < enemy_type_count; type++)
+	{
+		for (int clip = 0; clip < enemy_clip_count; clip++)
+		{
+			enemy_clips[type][clip] = (enemy_names[type] == nullptr) ? -1 : name_id(std::string(enemy_names[type]) + enemy_clip_names[clip]);
+		}
+	}
+
+	// every enemy type's clips, built here once so spawning an enemy only copies its set id
+	for (int type = 0; type < enemy_type_count; type++)
+	{
+		enemy_sets[type] = -1;
+	}
+	enemy_sets[(int)ENEMY_TYPES::FINAL_BOSS] = add_set({
+		{"final_boss_enemy_idle_f", 12, SPRITE_ASSET_ID::FINAL_BOSS, {0, 1, 2, 3, 4, 5, 6}},
+		{"final_boss_enemy_run_f", 10, SPRITE_ASSET_ID::FINAL_BOSS, {10, 11, 12, 13, 14, 15}},
+		{"final_boss_enemy_die", 10, SPRITE_ASSET_ID::FINAL_BOSS, {38, 39, 40, 41, 42, 43, 44, 45, 46}},
+		{"final_boss_enemy_attack_f", 10, SPRITE_ASSET_ID::FINAL_BOSS_ATTACK, {0, 1, 2, 3, 4, 5, 6, 7}},
+		{"final_boss_landlord", 10, SPRITE_ASSET_ID::FINAL_BOSS, {48}}});
+	enemy_sets[(int)ENEMY_TYPES::CONTACT_DMG] = add_set({
+		{"slowenemy_idle_f", 15, SPRITE_ASSET_ID::SKELETON, {0, 1, 2, 3, 4, 5}},
+		{"slowenemy_run_f", 10, SPRITE_ASSET_ID::SKELETON, {18, 19, 20, 21, 22, 23}},
+		{"slowenemy_die", 7, SPRITE_ASSET_ID::PLAYER, {36, 37, 38, 39, 39}}});
+	enemy_sets[(int)ENEMY_TYPES::CONTACT_DMG_2] = add_set({
+		{"fastenemy_idle_f", 2, SPRITE_ASSET_ID::SLIME, {0, 1}},
+		{"fastenemy_run_f", 8, SPRITE_ASSET_ID::SLIME, {10, 11, 12, 13, 14}},
+		{"fastenemy_die", 7, SPRITE_ASSET_ID::SLIME, {1, 2, 3, 4, 4}}});
+	enemy_sets[(int)ENEMY_TYPES::RANGED] = add_set({
+		{"rangedenemy_idle_f", 12, SPRITE_ASSET_ID::RANGED_ENEMY, {0, 1, 2, 3, 4}},
+		{"rangedenemy_run_f", 10, SPRITE_ASSET_ID::RANGED_ENEMY, {8, 9, 10, 11, 12, 13, 14, 15}},
+		{"rangedenemy_die", 7, SPRITE_ASSET_ID::RANGED_ENEMY, {32, 33, 34, 35, 36}}});
+	enemy_sets[(int)ENEMY_TYPES::RANGED_HOMING] = add_set({
+		{"rangedenemy_idle_f", 5, SPRITE_ASSET_ID::RANGED_ENEMY, {0, 1}},
+		{"rangedenemy_run_f", 9, SPRITE_ASSET_ID::RANGED_ENEMY, {6, 7, 8, 9}},
+		{"rangedenemy_die", 7, SPRITE_ASSET_ID::RANGED_ENEMY, {12, 13, 14, 15, 16, 17}}});
+	enemy_sets[(int)ENEMY_TYPES::SLOWING_CONTACT] = add_set({
+		{"fastenemy_idle_f", 2, SPRITE_ASSET_ID::SLOWING_ENEMY, {0, 1}},
+		{"fastenemy_run_f", 13, SPRITE_ASSET_ID::SLOWING_ENEMY, {4, 5, 6, 7}},
+		{"fastenemy_die", 5, SPRITE_ASSET_ID::SLOWING_ENEMY, {8, 9, 10}}});
+	enemy_sets[(int)ENEMY_TYPES::DASHING] = add_set({
+		{"slowenemy_idle_f", 2, SPRITE_ASSET_ID::DASHING_ENEMY, {7, 8, 9, 10}},
+		{"slowenemy_run_f", 13, SPRITE_ASSET_ID::DASHING_ENEMY, {7, 8, 9, 10}},
+		{"slowenemy_die", 7, SPRITE_ASSET_ID::DASHING_ENEMY, {14, 15, 16, 17, 18, 19, 20}},
+		{"slowenemy_dash", 7, SPRITE_ASSET_ID::DASHING_ENEMY, {21}}});
+	enemy_sets[(int)ENEMY_TYPES::SWARM] = add_set({
+		{"swarmenemy_idle_f", 10, SPRITE_ASSET_ID::BEETLE, {0, 1}}});
+}
+
+int AnimationLibrary::add_set(const std::vector<Animation> &set_clips)
+{
+	std::vector<int> ids;
+	std::string key;
+	for (const Animation &clip : set_clips)
+	{
+		ids.push_back(intern_clip(clip));
+		key += std::to_string(ids.back()) + ",";
+	}
+
+	auto it = set_ids.find(key);
+	if (it != set_ids.end())
+	{
+		return it->second;
+	}
+
+	std::vector<std::pair<int, int>> set;
+	for (size_t i = 0; i < set_clips.size(); i++)
+	{
+		set.push_back({name_id(set_clips[i].name), ids[i]});
+	}
+	sets.push_back(std::move(set));
+	set_ids[key] = (int)sets.size() - 1;
+	return (int)sets.size() - 1;
+}
+
+int AnimationLibrary::intern_clip(const Animation &clip)
+{
+	std::string key = clip.name + "|" + std::to_string(clip.frameRate) + "|" + std::to_string((int)clip.used_sprite) + "|";
+	for (int index : clip.sprite_indices)
+	{
+		key += std::to_string(index) + ",";
+	}
+
+	auto it = clip_ids.find(key);
+	if (it != clip_ids.end())
+	{
+		return it->second;
+	}
+
+	int id = (int)clips.size();
+	clips.push_back(clip);
+	frame_durations.push_back(1.f / clip.frameRate);
+	frame_counts.push_back((int)clip.sprite_indices.size());
+	first_frames.push_back((int)frames.size());
+	frames.insert(frames.end(), clip.sprite_indices.begin(), clip.sprite_indices.end());
+	clip_ids[key] = id;
+	return id;
+}
+
+int AnimationLibrary::name_id(const std::string &name)
+{
+	auto it = name_ids.find(name);
+	if (it != name_ids.end())
+	{
+		return it->second;
+	}
 
-    for(uint i = 0; i< animation_set_registry.size(); i++) {
-        AnimationSet& animationSet = animation_set_registry.components[i];
-        Entity entity = animation_set_registry.entities[i];
-        float step_seconds = elapsed_ms / 1000.f;
+	int id = (int)name_ids.size();
+	name_ids[name] = id;
+	return id;
+}
 
-        Animation& current_animation = animationSet.animations[animationSet.current_animation];
+int AnimationLibrary::find(int set_id, int name) const
+{
+	if (set_id < 0 || set_id >= (int)sets.size() || name < 0)
+	{
+		return -1;
+	}
+	for (const std::pair<int, int> &clip : sets[set_id])
+	{
+		if (clip.first == name)
+		{
+			return clip.second;
+		}
+	}
+	return -1;
+}
+
+void AnimationLibrary::play(AnimationSet &anim_set, int name) const
+{
+	int clip_id = find(anim_set.clip_set, name);
+	if (clip_id >= 0)
+	{
+		anim_set.current_clip = clip_id;
+	}
+}
+
+bool AnimationLibrary::is_playing(const AnimationSet &anim_set, int name) const
+{
+	return anim_set.current_clip >= 0 && anim_set.current_clip == find(anim_set.clip_set, name);
+}
+
+void AnimationLibrary::play(AnimationSet &anim_set, const std::string &name) const
+{
+	auto it = name_ids.find(name);
+	if (it != name_ids.end())
+	{
+		play(anim_set, it->second);
+	}
+}
 
-        animationSet.elapsed_time += step_seconds;
+bool AnimationLibrary::is_playing(const AnimationSet &anim_set, const std::string &name) const
+{
+	auto it = name_ids.find(name);
+	return it != name_ids.end() && is_playing(anim_set, it->second);
+}
 
-        float frame_duration = 1.f / current_animation.frameRate;
+void AnimationSystem::step(float elapsed_ms)
+{
+	auto& animation_set_registry = registry.animationSets;
+	const AnimationLibrary& library = animation_library;
+	float step_seconds = elapsed_ms / 1000.f;
 
-        if (animationSet.elapsed_time > frame_duration) {
-            if (registry.renderRequests.has(entity)) {
-                animationSet.current_frame = (animationSet.current_frame + 1) % current_animation.sprite_indices.size();
-                registry.renderRequests.get(entity).sprite_index = current_animation.sprite_indices[animationSet.current_frame];
+    // each entity only touches its own animation set and render request, so batches can run on any worker
+    jobs.parallel_for(animation_set_registry.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            AnimationSet& animationSet = animation_set_registry.components[i];
+            int clip = animationSet.current_clip;
+            if (clip < 0) {
+                continue;
             }
 
-            animationSet.elapsed_time = 0.0f;
-        }
+            animationSet.elapsed_time += step_seconds;
 
+            if (animationSet.elapsed_time > library.frame_durations[clip]) {
+                Entity entity = animation_set_registry.entities[i];
+                if (registry.renderRequests.has(entity)) {
+                    animationSet.current_frame = (animationSet.current_frame + 1) % library.frame_counts[clip];
+                    registry.renderRequests.get(entity).sprite_index = library.frames[library.first_frames[clip] + animationSet.current_frame];
+                }
 
-    }
+                animationSet.elapsed_time = 0.0f;
+            }
+        }
+    });
 }
\ No newline at end of file
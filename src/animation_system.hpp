@@ -1,10 +1,104 @@
 #pragma once
 
+// stlib
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "common.hpp"
 #include "tiny_ecs.hpp"
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
 
+// Clips the player switches between every step
+enum class PLAYER_CLIP
+{
+	RUN_S = 0,
+	RUN_F = RUN_S + 1,
+	RUN_B = RUN_F + 1,
+	IDLE_F = RUN_B + 1,
+	IDLE_S = IDLE_F + 1,
+	IDLE_B = IDLE_S + 1,
+	ATTACK_F = IDLE_B + 1,
+	ATTACK_S = ATTACK_F + 1,
+	ATTACK_B = ATTACK_S + 1,
+	DIE = ATTACK_B + 1,
+	PLAYER_CLIP_COUNT = DIE + 1
+};
+const int player_clip_count = (int)PLAYER_CLIP::PLAYER_CLIP_COUNT;
+
+// Clips the enemies switch between every step, each enemy type plays its own (types without one just don't switch)
+enum class ENEMY_CLIP
+{
+	IDLE_F = 0,
+	RUN_F = IDLE_F + 1,
+	ATTACK_F = RUN_F + 1,
+	DIE = ATTACK_F + 1,
+	LANDLORD = DIE + 1,
+	ENEMY_CLIP_COUNT = LANDLORD + 1
+};
+const int enemy_clip_count = (int)ENEMY_CLIP::ENEMY_CLIP_COUNT;
+const int enemy_type_count = (int)ENEMY_TYPES::DASHING + 1;
+
+// Every animation clip in the game, stored once and shared by all the entities that play it
+// Clips and clip sets are interned by their contents, each enemy type's set is added when the library is built
+// Clip names are interned to ids as well, the player and enemy clips when the library is built so the per step
+// switches never build or hash a string
+class AnimationLibrary
+{
+public:
+	AnimationLibrary();
+
+	// Adds a set of clips (or finds the identical set added before), returns the set id
+	int add_set(const std::vector<Animation> &clips);
+
+	// Id of a clip name, a name gets one the first time it is seen
+	int name_id(const std::string &name);
+
+	// Switches to the named clip of the entity's set, the frame and timer carry on (names not in the set are ignored)
+	void play(AnimationSet &anim_set, int name) const;
+	bool is_playing(const AnimationSet &anim_set, int name) const;
+	// by name, for one-off switches
+	void play(AnimationSet &anim_set, const std::string &name) const;
+	bool is_playing(const AnimationSet &anim_set, const std::string &name) const;
+
+	// the player's and enemies' per step switches, by the name ids interned when the library was built
+	void play(AnimationSet &anim_set, PLAYER_CLIP clip) const { play(anim_set, player_clips[(int)clip]); }
+	bool is_playing(const AnimationSet &anim_set, PLAYER_CLIP clip) const { return is_playing(anim_set, player_clips[(int)clip]); }
+	void play(AnimationSet &anim_set, ENEMY_TYPES type, ENEMY_CLIP clip) const { play(anim_set, enemy_clips[(int)type][(int)clip]); }
+	bool is_playing(const AnimationSet &anim_set, ENEMY_TYPES type, ENEMY_CLIP clip) const { return is_playing(anim_set, enemy_clips[(int)type][(int)clip]); }
+
+	// set of an enemy type's clips, -1 for the types without clips (projectiles)
+	int enemy_set(ENEMY_TYPES type) const { return enemy_sets[(int)type]; }
+
+	const Animation &current(const AnimationSet &anim_set) const { return clips[anim_set.current_clip]; }
+
+	// per clip data the animation system steps with, indexed by clip id
+	std::vector<float> frame_durations;
+	std::vector<int> frame_counts;
+	// first entry in frames for each clip, frames holds the sprite indices of every clip back to back
+	std::vector<int> first_frames;
+	std::vector<int> frames;
+
+private:
+	int intern_clip(const Animation &clip);
+	int find(int set_id, int name) const;
+
+	std::vector<Animation> clips;
+	std::unordered_map<std::string, int> clip_ids;
+	std::unordered_map<std::string, int> name_ids;
+	// (clip name id, clip id) for each set, a set only holds a handful of clips
+	std::vector<std::vector<std::pair<int, int>>> sets;
+	std::unordered_map<std::string, int> set_ids;
+
+	int player_clips[player_clip_count];
+	// -1 for the enemy types without clips (projectiles)
+	int enemy_clips[enemy_type_count][enemy_clip_count];
+	int enemy_sets[enemy_type_count];
+};
+
+extern AnimationLibrary animation_library;
+
 class AnimationSystem
 {
 public:
@@ -13,4 +107,4 @@ public:
 	AnimationSystem()
 	{
 	}
-};
\ No newline at end of file
+};
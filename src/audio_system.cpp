@@ -0,0 +1,308 @@
+// internal
+#include "audio_system.hpp"
+
+// stlib
+#include <algorithm>
+
+AudioSystem audio;
+
+AudioCommandQueue::AudioCommandQueue()
+{
+	for (uint32_t i = 0; i < CAPACITY; i++)
+	{
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool AudioCommandQueue::push(const AudioCommand &command, uint32_t reserved)
+{
+	uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Cell &cell = cells[pos & (CAPACITY - 1)];
+		uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+		int32_t diff = (int32_t)(sequence - pos);
+		if (diff == 0)
+		{
+			// free, but one of the cells kept back for more important pushes
+			if (pos - dequeue_pos.load(std::memory_order_acquire) >= CAPACITY - reserved)
+			{
+				return false;
+			}
+			// the cell is free, claim it
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				cell.command = command;
+				cell.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// full
+			return false;
+		}
+		else
+		{
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool AudioCommandQueue::pop(AudioCommand &command)
+{
+	uint32_t pos = dequeue_pos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Cell &cell = cells[pos & (CAPACITY - 1)];
+		uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+		int32_t diff = (int32_t)(sequence - (pos + 1));
+		if (diff == 0)
+		{
+			if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				command = cell.command;
+				// hand the cell back to producers one lap later
+				cell.sequence.store(pos + CAPACITY, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// empty
+			return false;
+		}
+		else
+		{
+			pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool AudioSystem::init(const std::string &bank_path)
+{
+	if (running.load())
+	{
+		return true;
+	}
+
+	if (!bank.open(bank_path))
+	{
+		return false;
+	}
+	bank.report("opened");
+
+	Mix_AllocateChannels(CHANNEL_COUNT);
+	frame_requests.reserve(sound_count);
+	running.store(true);
+	thread = std::thread(&AudioSystem::thread_loop, this);
+	return true;
+}
+
+void AudioSystem::shutdown()
+{
+	if (!thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		running.store(false);
+	}
+	wake_cv.notify_one();
+	thread.join();
+
+	Mix_HaltChannel(-1);
+	bank.report("shutdown");
+	bank.release_all();
+}
+
+AudioSystem::~AudioSystem()
+{
+	shutdown();
+}
+
+void AudioSystem::configure(SOUND_ASSET_ID sound, int max_voices, int priority)
+{
+	settings[(int)sound] = {std::max(max_voices, 1), priority};
+}
+
+void AudioSystem::push(AudioCommand::TYPE type, SOUND_ASSET_ID sound)
+{
+	if (sound == SOUND_ASSET_ID::SOUND_COUNT)
+	{
+		return;
+	}
+
+	AudioCommand command;
+	command.type = type;
+	command.sound = sound;
+	// the last cell is kept for end_frame's marker
+	if (!queue.push(command, 1))
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void AudioSystem::play(SOUND_ASSET_ID sound)
+{
+	push(AudioCommand::TYPE::PLAY, sound);
+}
+
+void AudioSystem::prefetch(SOUND_ASSET_ID sound)
+{
+	push(AudioCommand::TYPE::PREFETCH, sound);
+}
+
+void AudioSystem::end_frame()
+{
+	if (!running.load(std::memory_order_relaxed))
+	{
+		// no audio thread (the mixer failed to open), throw the frame's requests away
+		AudioCommand command;
+		while (queue.pop(command))
+		{
+		}
+		return;
+	}
+
+	AudioCommand command;
+	command.type = AudioCommand::TYPE::FRAME_END;
+	// requests can't take the last cell, so this only fails while an earlier frame's marker is still queued
+	// that frame was already counted in frames_ready, so the audio thread is awake and draining the queue
+	while (!queue.push(command))
+	{
+		std::this_thread::yield();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		frames_ready += 1;
+	}
+	wake_cv.notify_one();
+}
+
+void AudioSystem::thread_loop()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(wake_mutex);
+			wake_cv.wait(lock, [this]()
+						 { return frames_ready.load() > 0 || !running.load(); });
+			if (!running.load())
+			{
+				return;
+			}
+			frames_ready -= 1;
+		}
+		dispatch_frame();
+	}
+}
+
+void AudioSystem::dispatch_frame()
+{
+	// collect one frame's requests, a sound asked for several times is only played once
+	frame_requests.clear();
+	AudioCommand command;
+	while (queue.pop(command) && command.type != AudioCommand::TYPE::FRAME_END)
+	{
+		if (command.type == AudioCommand::TYPE::PREFETCH)
+		{
+			bank.acquire(command.sound, frame_number);
+			continue;
+		}
+		if (requested[(int)command.sound])
+		{
+			merged.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		requested[(int)command.sound] = true;
+		frame_requests.push_back(command.sound);
+	}
+
+	for (SOUND_ASSET_ID sound : frame_requests)
+	{
+		requested[(int)sound] = false;
+		start_voice(sound);
+	}
+
+	// sounds still playing can't be freed, the rest go least recently used first
+	bank.evict(MEMORY_BUDGET, [this](SOUND_ASSET_ID sound)
+			   { return playing(sound); });
+	frame_number += 1;
+}
+
+void AudioSystem::start_voice(SOUND_ASSET_ID sound)
+{
+	const SoundSettings &settings_for_sound = settings[(int)sound];
+
+	int voice_count = 0;
+	int free_channel = -1;
+	int victim = -1;
+	for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+	{
+		if (!Mix_Playing(channel))
+		{
+			voices[channel].sound = SOUND_ASSET_ID::SOUND_COUNT;
+			if (free_channel < 0)
+			{
+				free_channel = channel;
+			}
+			continue;
+		}
+
+		Voice &voice = voices[channel];
+		if (voice.sound == sound)
+		{
+			voice_count += 1;
+		}
+		// only a strictly lower priority sound can be cut off, the oldest of the lowest goes first
+		if (voice.priority < settings_for_sound.priority &&
+			(victim < 0 || voice.priority < voices[victim].priority ||
+			 (voice.priority == voices[victim].priority && voice.started < voices[victim].started)))
+		{
+			victim = channel;
+		}
+	}
+
+	if (voice_count >= settings_for_sound.max_voices)
+	{
+		merged.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	int channel = free_channel;
+	if (channel < 0)
+	{
+		if (victim < 0)
+		{
+			// every channel is playing something at least as important
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		Mix_HaltChannel(victim);
+		channel = victim;
+	}
+
+	Mix_Chunk *chunk = bank.acquire(sound, frame_number);
+	if (chunk == nullptr || Mix_PlayChannel(channel, chunk, 0) == -1)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	voices[channel] = {sound, settings_for_sound.priority, frame_number};
+}
+
+bool AudioSystem::playing(SOUND_ASSET_ID sound) const
+{
+	for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+	{
+		if (voices[channel].sound == sound && Mix_Playing(channel))
+		{
+			return true;
+		}
+	}
+	return false;
+}
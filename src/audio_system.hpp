@@ -0,0 +1,137 @@
+#pragma once
+
+// stlib
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SDL_mixer.h>
+
+#include "components.hpp"
+#include "sound_bank.hpp"
+
+// What gameplay asks the audio thread to do
+struct AudioCommand
+{
+	enum class TYPE
+	{
+		PLAY = 0,
+		// decode the sound now so its first play doesn't wait for it
+		PREFETCH = PLAY + 1,
+		// everything queued before this belongs to one frame
+		FRAME_END = PREFETCH + 1,
+	};
+
+	TYPE type = TYPE::PLAY;
+	SOUND_ASSET_ID sound = SOUND_ASSET_ID::SOUND_COUNT;
+};
+
+// Bounded lock-free queue, any thread can push, only the audio thread pops (Vyukov's bounded MPMC queue)
+class AudioCommandQueue
+{
+public:
+	static const uint32_t CAPACITY = 1024;
+
+	AudioCommandQueue();
+
+	// false if the queue is full, the command is dropped
+	// reserved cells are left free for pushes that pass a smaller reserve
+	bool push(const AudioCommand &command, uint32_t reserved = 0);
+	bool pop(AudioCommand &command);
+
+private:
+	struct Cell
+	{
+		std::atomic<uint32_t> sequence;
+		AudioCommand command;
+	};
+
+	Cell cells[CAPACITY];
+	std::atomic<uint32_t> enqueue_pos{0};
+	std::atomic<uint32_t> dequeue_pos{0};
+};
+
+// Plays sound effects from its own thread so gameplay never waits on SDL_mixer
+// Requests for the same sound made in one frame are merged into one, each sound has a cap on how many copies
+// may be heard at once, and when every channel is busy a request can take over the channel of a lower priority sound
+// The thread owns the sound bank, so sounds are decoded there on first use (or on prefetch) and evicted there too
+// Music is left to SDL_mixer directly on the main thread
+// Works the same with no sound card (SDL_AUDIODRIVER=dummy), which is how to exercise it headless
+class AudioSystem
+{
+public:
+	static const int CHANNEL_COUNT = 16;
+	// decoded sample memory kept around for sounds that aren't playing
+	static const size_t MEMORY_BUDGET = 1 << 20;
+
+	// call once the mixer is open, opens (or bakes) the sound bank at bank_path
+	bool init(const std::string &bank_path);
+	// stops the thread and frees every decoded sound, call before the mixer is closed
+	void shutdown();
+
+	// max_voices copies of sound may play at once, higher priority sounds take channels from lower ones
+	// call before init()
+	void configure(SOUND_ASSET_ID sound, int max_voices, int priority);
+
+	// queues sound to be played, safe from any thread
+	void play(SOUND_ASSET_ID sound);
+	// queues sound to be decoded ahead of its first play (e.g. the sounds a level uses, when it loads)
+	void prefetch(SOUND_ASSET_ID sound);
+	// hands this frame's requests to the audio thread, call once per frame from the main loop
+	void end_frame();
+
+	// requests lost to a full queue or to every channel being taken by more important sounds
+	uint32_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+	// requests folded into a same-frame duplicate or refused by the sound's voice cap
+	uint32_t merged_count() const { return merged.load(std::memory_order_relaxed); }
+
+	~AudioSystem();
+
+private:
+	struct SoundSettings
+	{
+		int max_voices = 4;
+		int priority = 0;
+	};
+
+	// what the audio thread knows about each channel
+	struct Voice
+	{
+		SOUND_ASSET_ID sound = SOUND_ASSET_ID::SOUND_COUNT;
+		int priority = 0;
+		// frame it was started in, older voices are stolen first
+		uint64_t started = 0;
+	};
+
+	void thread_loop();
+	void push(AudioCommand::TYPE type, SOUND_ASSET_ID sound);
+	void dispatch_frame();
+	void start_voice(SOUND_ASSET_ID sound);
+	bool playing(SOUND_ASSET_ID sound) const;
+
+	AudioCommandQueue queue;
+	std::thread thread;
+	std::atomic<bool> running{false};
+	std::atomic<int> frames_ready{0};
+	std::mutex wake_mutex;
+	std::condition_variable wake_cv;
+
+	// written by configure() before the thread starts
+	SoundSettings settings[sound_count];
+
+	// audio thread only
+	SoundBank bank;
+	std::vector<SOUND_ASSET_ID> frame_requests;
+	bool requested[sound_count] = {};
+	Voice voices[CHANNEL_COUNT];
+	uint64_t frame_number = 0;
+
+	std::atomic<uint32_t> dropped{0};
+	std::atomic<uint32_t> merged{0};
+};
+
+extern AudioSystem audio;
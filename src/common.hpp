@@ -1,6 +1,7 @@
 #pragma once
 
 // standard libs
+#include <cmath>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -33,6 +34,21 @@ inline std::string tutorial_path(const std::string &name) { return data_path() +
 const int window_width_px = 1280;
 const int window_height_px = 720;
 
+// The tile map's grid in world space, tile (0, 0) starts at (GRID_OFFSET_X, GRID_OFFSET_Y)
+const int TILE_SIZE = 100;
+const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE));
+const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE));
+
+// Tile a world position is on, floored so positions left of / above the map still land in their own tile
+inline ivec2 world_to_tile(vec2 pos)
+{
+	return {(int)std::floor((pos.x - GRID_OFFSET_X) / TILE_SIZE), (int)std::floor((pos.y - GRID_OFFSET_Y) / TILE_SIZE)};
+}
+inline vec2 tile_min(ivec2 tile) { return {GRID_OFFSET_X + tile.x * TILE_SIZE, GRID_OFFSET_Y + tile.y * TILE_SIZE}; }
+inline vec2 tile_centre(ivec2 tile) { return tile_min(tile) + vec2(TILE_SIZE / 2.f); }
+// Map tiles enemies walk on and see across: floor, floor decorations and everything numbered past the walls
+inline bool tile_walkable(int tile) { return tile == 1 || (tile >= 3 && tile <= 8) || tile > 38; }
+
 const std::string SAVE_FILENAME = "save.json";
 
 #ifndef M_PI
@@ -53,9 +69,9 @@ struct Transform
 // font character structure
 struct Character
 {
-	unsigned int TextureID; // ID handle of the glyph texture
-	glm::ivec2 Size;		// Size of glyph
-	glm::ivec2 Bearing;		// Offset from baseline to left/top of glyph
+	glm::vec4 uv;			// Rect of the glyph's distance field in the font atlas (u, v, width, height)
+	glm::ivec2 Size;		// Size of glyph, including the distance field's padding
+	glm::ivec2 Bearing;		// Offset from baseline to left/top of glyph, including the padding
 	unsigned int Advance;	// Offset to advance to next glyph
 	char character;
 };
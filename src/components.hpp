@@ -126,7 +126,6 @@ struct Deadly
 	float drop_chance = 1.0f;
 	int experience = 1;
 	ENEMY_STATE state = ENEMY_STATE::IDLE;
-	vec2 knocked_back_pos = {INFINITY, INFINITY};
 };
 
 struct EnemyKnockback {
@@ -192,6 +191,26 @@ struct Projectile
 {
 };
 
+// Movement kinds that have no data component of their own, tagged at spawn so PhysicsSystem::step can run each
+// movement kernel over just its own batch (swarms, bosses and projectiles already have one)
+// Enemies that path towards the player: contact, ranged and slowing
+struct Chaser
+{
+	// time its AI hasn't caught up on yet, off-screen enemies only update every few frames (see AiLodScheduler)
+	float pending_seconds = 0.f;
+};
+
+// Dashing enemies (the boss also has an EnemyDash but moves on its own)
+struct Dasher
+{
+	float pending_seconds = 0.f;
+};
+
+// Projectiles that turn towards the player every step
+struct Homing
+{
+};
+
 struct Experience
 {
 	int experience;
@@ -202,9 +221,13 @@ struct Collectible
 	bool is_collected = false;
 };
 
+// Names a path stored in the path pool (path_pool.hpp)
+typedef uint32_t PathHandle;
+const PathHandle INVALID_PATH = UINT32_MAX;
+
 struct Path
 {
-	std::vector<vec2> points;
+	PathHandle points = INVALID_PATH;
 	size_t current_index = 0;
 };
 
@@ -283,12 +306,51 @@ struct Motion
 	vec2 renderPositionOffset = {0, 0};
 };
 
+// How long a moving collider has sat still, kept up to date by the physics collision pass
+// It sleeps once it has been still and clear of every other moving collider for a while, and wakes as soon as its
+// velocity, position or size changes or an awake collider touches it
+struct Rest
+{
+	vec2 position = {0, 0};
+	vec2 scale = {0, 0};
+	int steps_at_rest = 0;
+};
+
+// Collision layer of an entity, stored in registry.colliders
+// Entities without one (text, UI, camera, floor, effects...) never take part in collision checks
+enum class COLLISION_LAYER : uint8_t
+{
+	NONE = 0,
+	PLAYER = NONE + 1,
+	ENEMY = PLAYER + 1,
+	PROJECTILE = ENEMY + 1,
+	ATTACK = PROJECTILE + 1, // player attack hitboxes
+	SOLID = ATTACK + 1, // walls and furniture
+	TRIGGER = SOLID + 1, // stickies, eatables, hold interacts and doors
+	LAYER_COUNT = TRIGGER + 1
+};
+const int collision_layer_count = (int)COLLISION_LAYER::LAYER_COUNT;
+
+// Kinds of contact the game reacts to, worked out once by the physics system when the pair is found
+enum class COLLISION_TYPE
+{
+	PLAYER_ENEMY = 0, // deadlys (enemies and their projectiles) and spikes
+	PLAYER_COLLECTIBLE = PLAYER_ENEMY + 1, // eatables
+	PLAYER_STICKY = PLAYER_COLLECTIBLE + 1,
+	PLAYER_INTERACT = PLAYER_STICKY + 1, // hold interacts
+	PLAYER_DOOR = PLAYER_INTERACT + 1,
+	PROJECTILE_SOLID = PLAYER_DOOR + 1,
+	ATTACK_ENEMY = PROJECTILE_SOLID + 1,
+	COLLISION_TYPE_COUNT = ATTACK_ENEMY + 1
+};
+
 // Stucture to store collision information
-struct Collision
+// Each contact is recorded once per kind, first is the player / projectile / attack named by the type
+struct CollisionPair
 {
-	// Note, the first object is stored in the ECS container.entities
-	Entity other; // the second object involved in the collision
-	Collision(Entity &other) { this->other = other; };
+	COLLISION_TYPE type;
+	Entity first;
+	Entity second;
 };
 
 // Data structure for toggling debug mode
@@ -485,7 +547,9 @@ struct Tenant
 	std::vector<std::string> extra_dialogues;
 	bool player_in_radius = false;
 	bool on_path = false;
-	std::vector<vec2> path = {};
+	PathHandle path = INVALID_PATH;
+	// next point of the path to walk to
+	size_t path_index = 0;
 };
 
 struct UpgradeConfirm
@@ -497,16 +561,6 @@ struct Camera
 {
 };
 
-struct DamageIndicator
-{
-	float time_total_ms = 1000.0f;
-	float time_elapsed_ms = time_total_ms;
-	int damage;
-	float rng;
-	float multiplier;
-	Entity text;
-};
-
 struct BarIn
 {
 };
@@ -702,7 +756,10 @@ enum class EFFECT_ASSET_ID
 	FONT = WATER + 1,
 	DASH = FONT + 1,
 	SMOKE = DASH + 1,
-	EFFECT_COUNT = SMOKE + 1
+	HP_BAR = SMOKE + 1,
+	DEBUG_DRAW = HP_BAR + 1,
+	DAMAGE_NUMBER = DEBUG_DRAW + 1,
+	EFFECT_COUNT = DAMAGE_NUMBER + 1
 };
 const int effect_count = (int)EFFECT_ASSET_ID::EFFECT_COUNT;
 
@@ -717,6 +774,21 @@ enum class GEOMETRY_BUFFER_ID
 };
 const int geometry_count = (int)GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
 
+enum class SOUND_ASSET_ID
+{
+	BUTTON_CLICK = 0,
+	SALMON_EAT = BUTTON_CLICK + 1,
+	PLAYER_DAMAGE = SALMON_EAT + 1,
+	ENEMY_DAMAGE = PLAYER_DAMAGE + 1,
+	LEVEL_UP = ENEMY_DAMAGE + 1,
+	LEVEL_UP_LOAD = LEVEL_UP + 1,
+	DOOR = LEVEL_UP_LOAD + 1,
+	SUMMON = DOOR + 1,
+	EXP = SUMMON + 1,
+	SOUND_COUNT = EXP + 1
+};
+const int sound_count = (int)SOUND_ASSET_ID::SOUND_COUNT;
+
 struct SpriteSheetInfo
 {
 	TEXTURE_ASSET_ID texture_id;
@@ -726,6 +798,21 @@ struct SpriteSheetInfo
 	int sprite_height;
 };
 
+// Texture coordinates of one frame of a sprite sheet
+struct SpriteUV
+{
+	vec2 offset;
+	vec2 scale;
+};
+
+// A sprite sheet compiled for drawing, its frames are sprite_uvs[first_frame, first_frame + frame_count)
+struct SpriteSheetEntry
+{
+	TEXTURE_ASSET_ID texture = TEXTURE_ASSET_ID::TEXTURE_COUNT;
+	int first_frame = 0;
+	int frame_count = 0;
+};
+
 struct RenderRequest
 {
 	TEXTURE_ASSET_ID used_texture = TEXTURE_ASSET_ID::TEXTURE_COUNT;
@@ -744,10 +831,11 @@ struct Animation
 	std::vector<int> sprite_indices;							 // list of indices used in animation
 };
 
+// Clips themselves live in the animation library, entities only keep which ones they play
 struct AnimationSet
 {
-	std::unordered_map<std::string, Animation> animations;
-	std::string current_animation;
+	int clip_set = -1;
+	int current_clip = -1;
 	int current_frame = 0;
 	float elapsed_time = 0.0f;
 };
@@ -0,0 +1,91 @@
+// internal
+#include "continuous_collision.hpp"
+#include "solid_grid.hpp"
+
+SweepHit sweep_aabb(vec2 pos, vec2 half, vec2 delta, vec2 other_min, vec2 other_max)
+{
+	SweepHit result;
+
+	// grow the other box by the mover's size, then the mover is just its centre moving along a ray
+	vec2 box_min = other_min - half;
+	vec2 box_max = other_max + half;
+
+	float entry = -INFINITY;
+	float exit = INFINITY;
+	vec2 normal = {0, 0};
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (delta[axis] == 0.f)
+		{
+			// not moving along this axis, has to already be inside the slab
+			if (pos[axis] <= box_min[axis] || pos[axis] >= box_max[axis])
+			{
+				return result;
+			}
+			continue;
+		}
+
+		float near_side = (delta[axis] > 0.f) ? box_min[axis] : box_max[axis];
+		float far_side = (delta[axis] > 0.f) ? box_max[axis] : box_min[axis];
+		float t_near = (near_side - pos[axis]) / delta[axis];
+		float t_far = (far_side - pos[axis]) / delta[axis];
+
+		if (t_near > entry)
+		{
+			entry = t_near;
+			normal = {0, 0};
+			normal[axis] = (delta[axis] > 0.f) ? -1.f : 1.f;
+		}
+		exit = min(exit, t_far);
+	}
+
+	// misses or grazes, is behind the mover, or is too far away to reach it with this move
+	if (entry >= exit || exit <= 0.f || entry > 1.f)
+	{
+		return result;
+	}
+
+	if (entry < 0.f)
+	{
+		// already overlapping, the way out is along the axis it overlaps least
+		vec2 centre = (box_min + box_max) / 2.f;
+		vec2 depth = (box_max - box_min) / 2.f - abs(pos - centre);
+		int axis = (depth.x < depth.y) ? 0 : 1;
+		vec2 out = {0, 0};
+		out[axis] = (pos[axis] < centre[axis]) ? -1.f : 1.f;
+		if (dot(delta, out) >= 0.f)
+		{
+			return result;
+		}
+
+		result.hit = true;
+		result.time = 0.f;
+		result.normal = out;
+		return result;
+	}
+
+	result.hit = true;
+	result.time = entry;
+	result.normal = normal;
+	return result;
+}
+
+// The solid grid as a solid query, only the solids bucketed under the box can be hit
+struct GridSolids
+{
+	template <typename Visit>
+	void operator()(vec2 box_min, vec2 box_max, Visit visit) const
+	{
+		solid_grid.any_of(box_min, box_max, visit);
+	}
+};
+
+SweepHit sweep_solids(const Motion &motion, vec2 delta)
+{
+	return sweep_solids(motion, delta, GridSolids());
+}
+
+bvec2 move_and_slide(Motion &motion, vec2 delta)
+{
+	return move_and_slide(motion, delta, GridSolids());
+}
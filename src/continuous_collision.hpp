@@ -0,0 +1,98 @@
+#pragma once
+
+#include "common.hpp"
+#include "components.hpp"
+
+// gap left between a mover and the solid it stopped against, so rounding never leaves them overlapping
+const float SWEEP_SKIN = 0.01f;
+
+// Result of sweeping a bounding box along a displacement
+struct SweepHit
+{
+	bool hit = false;
+	// fraction of the displacement that can be travelled before touching (1 if nothing was hit)
+	float time = 1.f;
+	// axis aligned normal of the face that was hit, points back towards the mover
+	vec2 normal = {0, 0};
+};
+
+// Sweeps the box centred on pos with half size half along delta against the box [other_min, other_max]
+// Boxes that only touch do not hit
+// Boxes that already overlap at the start hit at time 0 if the move goes deeper along the axis of least overlap,
+// moves back out along it are let through so a mover that ended up inside can still leave
+SweepHit sweep_aabb(vec2 pos, vec2 half, vec2 delta, vec2 other_min, vec2 other_max);
+
+// Sweeps the mover's bounding box along delta against the solid objects, returns the earliest hit
+SweepHit sweep_solids(const Motion &motion, vec2 delta);
+
+// Moves the mover along delta, stopping at the first solid hit and sliding along it for the rest of the move
+// Returns which axes were blocked
+bvec2 move_and_slide(Motion &motion, vec2 delta);
+
+// Same, against the solids found by query instead of the solid grid
+// query(box_min, box_max, visit) calls visit(const Motion &solid) for every solid that may overlap the box (visiting
+// one more than once is fine) and stops early once visit returns true
+template <typename Query>
+SweepHit sweep_solids(const Motion &motion, vec2 delta, Query query);
+template <typename Query>
+bvec2 move_and_slide(Motion &motion, vec2 delta, Query query);
+
+template <typename Query>
+SweepHit sweep_solids(const Motion &motion, vec2 delta, Query query)
+{
+	SweepHit first;
+	if (delta.x == 0.f && delta.y == 0.f)
+	{
+		return first;
+	}
+
+	vec2 half = abs(motion.scale) / 2.f;
+	vec2 end = motion.position + delta;
+
+	// only solids under the box covering the whole move can be hit
+	query(min(motion.position, end) - half, max(motion.position, end) + half, [&](const Motion &motion_solid)
+	{
+		vec2 solid_half = abs(motion_solid.scale) / 2.f;
+		SweepHit hit = sweep_aabb(motion.position, half, delta, motion_solid.position - solid_half, motion_solid.position + solid_half);
+		if (hit.hit && (!first.hit || hit.time < first.time))
+		{
+			first = hit;
+		}
+		return false;
+	});
+
+	return first;
+}
+
+template <typename Query>
+bvec2 move_and_slide(Motion &motion, vec2 delta, Query query)
+{
+	bvec2 blocked = {false, false};
+
+	SweepHit hit = sweep_solids(motion, delta, query);
+	if (!hit.hit)
+	{
+		motion.position += delta;
+		return blocked;
+	}
+
+	int axis = (hit.normal.x != 0.f) ? 0 : 1;
+	blocked[axis] = true;
+	motion.position += delta * hit.time + hit.normal * SWEEP_SKIN;
+
+	// rest of the move, without the part going into the solid
+	vec2 remaining = delta * (1.f - hit.time);
+	remaining[axis] = 0.f;
+
+	SweepHit slide = sweep_solids(motion, remaining, query);
+	if (slide.hit)
+	{
+		blocked[1 - axis] = true;
+		motion.position += remaining * slide.time + slide.normal * SWEEP_SKIN;
+	}
+	else
+	{
+		motion.position += remaining;
+	}
+	return blocked;
+}
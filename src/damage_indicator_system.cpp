@@ -1,83 +1,89 @@
 // internal
 #include "damage_indicator_system.hpp"
-#include "world_init.hpp"
-#include <iostream>
 
-const float RESIZE_SCALE = 1.0f;
+// stlib
+#include <string>
+
 const vec3 MULTIPLIER_COLOR = vec3(0.647, 0.188, 0.188);
 const vec3 RNG_COLOR = vec3(0.745, 0.467, 0.169);
+// expired digits are only removed once there are this many of them (or nothing is left alive)
+const size_t COMPACT_BATCH = 64;
+
+DamageNumbers damage_numbers;
 
-mat3 createProjectionMatrix(vec2 position)
+void DamageNumbers::spawn(int damage, vec2 position, float rng, float multiplier)
 {
-    // Fake projection matrix, scales with respect to window coordinates
-    float left = 0.f;
-    float top = 0.f;
+    vec3 text_color = vec3(1.f, 1.f, 1.f);
+
+    if (rng > 0.0f)
+    {
+        text_color = RNG_COLOR;
+        float ratio = 1 / (rng / 0.25);
+        text_color *= vec3(ratio);
+    }
 
-    gl_has_errors();
-    float right = (float)window_width_px;
-    float bottom = (float)window_height_px;
+    if (multiplier > 1.0f)
+    {
+        text_color = MULTIPLIER_COLOR;
+    }
 
-    float sx = 2.f / (right - left);
-    float sy = 2.f / (top - bottom);
-    float tx = -(right + left) / (right - left) - (position.x - window_width_px / 2.f) * sx;
-    float ty = -(top + bottom) / (top - bottom) - (position.y - window_height_px / 2.f) * sy;
-    return {{sx, 0.f, 0.f}, {0.f, sy, 0.f}, {tx, ty, 1.f}};
+    std::string text = std::to_string(abs(damage));
+    float pen_x = 0.f;
+    for (char c : text)
+    {
+        int digit = c - '0';
+        live.push_back({position, now(), (float)digit, pen_x, text_color});
+        pen_x += digit_advance[digit];
+    }
 }
 
-vec2 convertToScreenSpace(vec2 position)
+void DamageNumbers::advance(float elapsed_ms)
 {
-    vec2 cameraPosition;
+    clock_ms += elapsed_ms;
 
-    // sus code : assumes only one camera and that its always present
-    for (Entity entity : registry.cameras.entities)
+    size_t expired = 0;
+    while (expired < live.size() && now() - live[expired].spawn_ms >= LIFETIME_MS)
     {
-        auto &cameraMotion = registry.motions.get(entity);
-        cameraPosition = cameraMotion.position;
+        expired++;
     }
 
-    // converts to normalized device coordinates
-    vec2 screenPosition = createProjectionMatrix(cameraPosition) * vec3(position.x, position.y, 1.0f);
-
-    // converts ndc to screen coordinates
-    screenPosition.x = (screenPosition.x + 1.0f) * window_width_px / 2;
-    screenPosition.y = (screenPosition.y + 1.0f) * window_height_px / 2;
+    // expired digits still drawn in the meantime are invisible, the shader has them fully faded out
+    if (expired > 0 && (expired >= COMPACT_BATCH || expired == live.size()))
+    {
+        live.erase(live.begin(), live.begin() + expired);
+        rebase();
+        removal_generation++;
+    }
+}
 
-    return screenPosition;
+void DamageNumbers::clear()
+{
+    live.clear();
+    rebase();
+    removal_generation++;
 }
 
-void DamageIndicatorSystem::step(float elapsed_ms)
+void DamageNumbers::rebase()
 {
-    for (Entity entity : registry.damageIndicators.entities)
+    // the digits left were spawned less than LIFETIME_MS ago, their times go slightly negative
+    // only called when the generation changes, the GPU copy is rebuilt with the new times
+    float shift = now();
+    for (DamageDigit &digit : live)
     {
-        auto &damageIndicatorComponent = registry.damageIndicators.get(entity);
-        auto &damageMotion = registry.motions.get(entity);
-
-        damageIndicatorComponent.time_elapsed_ms -= elapsed_ms;
-
-        float time_frac = (damageIndicatorComponent.time_elapsed_ms / damageIndicatorComponent.time_total_ms);
-
-        float scale = sin(time_frac * M_PI * RESIZE_SCALE);
-
-        if (damageIndicatorComponent.time_elapsed_ms < 0)
-        {
-            registry.remove_all_components_of(entity);
-        }
-
-        vec3 text_color = vec3(1.f, 1.f, 1.f);
-
-        if (damageIndicatorComponent.rng > 0.0f)
-        {
-            text_color = RNG_COLOR;
-            float ratio = 1 / (damageIndicatorComponent.rng / 0.25);
-            text_color *= vec3(ratio);
-        }
-
-        if (damageIndicatorComponent.multiplier > 1.0f)
-        {
-            text_color = MULTIPLIER_COLOR;
-        }
-
+        digit.spawn_ms -= shift;
+    }
+    epoch_ms = clock_ms;
+}
 
-        damageIndicatorComponent.text = createText(convertToScreenSpace(damageMotion.position), scale, std::to_string(damageIndicatorComponent.damage), text_color);
+void DamageNumbers::set_digit_advances(const float advances[10])
+{
+    for (int i = 0; i < 10; i++)
+    {
+        digit_advance[i] = advances[i];
     }
-}
\ No newline at end of file
+}
+
+void DamageIndicatorSystem::step(float elapsed_ms)
+{
+    damage_numbers.advance(elapsed_ms);
+}
@@ -5,8 +5,57 @@
 #include "tiny_ecs_registry.hpp"
 #include "common.hpp"
 
+// One digit of a damage number, laid out the way the damage number shader reads it
+struct DamageDigit
+{
+	// world position the number was spawned at
+	vec2 position;
+	// damage number clock when it was spawned, relative to the clock's current epoch
+	float spawn_ms;
+	float digit;
+	// offset of the glyph from the start of the number, in pixels at full size
+	float pen_x;
+	vec3 color;
+};
+
+// Damage numbers live here rather than in the ECS: a number is written once when the hit lands and the
+// vertex shader animates it (grow and shrink, fade, rise) from the clock, nothing is updated per frame
+// Every number lives for the same time, so expired ones are always at the front and are dropped in batches
+class DamageNumbers
+{
+public:
+	static constexpr float LIFETIME_MS = 1000.f;
+
+	void spawn(int damage, vec2 position, float rng, float multiplier);
+	// moves the clock on and drops expired numbers once enough of them have piled up
+	void advance(float elapsed_ms);
+	void clear();
+
+	// set by the renderer once the font is loaded, needed to lay digits out
+	void set_digit_advances(const float advances[10]);
+
+	// clock relative to the epoch, what the shader compares spawn_ms against
+	// the epoch moves up to the clock whenever digits are removed, so this stays small however long the game runs
+	float now() const { return (float)(clock_ms - epoch_ms); }
+	const std::vector<DamageDigit> &digits() const { return live; }
+	// changes whenever digits were removed, the GPU copy then has to be rebuilt rather than appended to
+	uint32_t generation() const { return removal_generation; }
+
+private:
+	void rebase();
+
+	std::vector<DamageDigit> live;
+	// total time in double, a float clock stops advancing by a frame's worth after a few hours
+	double clock_ms = 0.0;
+	double epoch_ms = 0.0;
+	float digit_advance[10] = {};
+	uint32_t removal_generation = 0;
+};
+
+extern DamageNumbers damage_numbers;
+
 class DamageIndicatorSystem
 {
 public:
 	void step(float elapsed_ms);
-};
\ No newline at end of file
+};
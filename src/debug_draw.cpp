@@ -0,0 +1,57 @@
+// internal
+#include "debug_draw.hpp"
+
+DebugDraw debug_draw;
+
+void DebugDraw::line(vec2 from, vec2 to, vec3 color)
+{
+	vertices.push_back({from, color});
+	vertices.push_back({to, color});
+}
+
+void DebugDraw::box(vec2 centre, vec2 size, vec3 color)
+{
+	vec2 half = abs(size) / 2.f;
+	vec2 top_left = centre - half;
+	vec2 bottom_right = centre + half;
+	vec2 top_right = {bottom_right.x, top_left.y};
+	vec2 bottom_left = {top_left.x, bottom_right.y};
+
+	line(top_left, top_right, color);
+	line(top_right, bottom_right, color);
+	line(bottom_right, bottom_left, color);
+	line(bottom_left, top_left, color);
+}
+
+void DebugDraw::circle(vec2 centre, float radius, vec3 color, int segments)
+{
+	const float TWO_PI = 6.28318531f;
+	vec2 previous = centre + vec2(radius, 0.f);
+	for (int i = 1; i <= segments; i++)
+	{
+		float angle = TWO_PI * i / segments;
+		vec2 next = centre + radius * vec2(cos(angle), sin(angle));
+		line(previous, next, color);
+		previous = next;
+	}
+}
+
+void DebugDraw::path(const vec2 *points, size_t count, vec3 color)
+{
+	for (size_t i = 1; i < count; i++)
+	{
+		line(points[i - 1], points[i], color);
+	}
+}
+
+void DebugDraw::text(vec2 position, const std::string &content, vec3 color, float scale)
+{
+	label_list.push_back({position, scale, color, content});
+}
+
+void DebugDraw::clear()
+{
+	// keeps the capacity, debug mode draws about the same every frame
+	vertices.clear();
+	label_list.clear();
+}
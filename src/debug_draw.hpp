@@ -0,0 +1,48 @@
+#pragma once
+
+// stlib
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+// Immediate mode debug drawing in world coordinates
+// Anything can add shapes during the step, the renderer draws all the lines of a frame in one call and the text with the rest of the text
+// Nothing goes through the ECS, clear() throws the frame's shapes away at the start of the next step
+class DebugDraw
+{
+public:
+	struct Vertex
+	{
+		vec2 position;
+		vec3 color;
+	};
+
+	struct Label
+	{
+		vec2 position;
+		float scale;
+		vec3 color;
+		std::string content;
+	};
+
+	void line(vec2 from, vec2 to, vec3 color);
+	// outline of the axis aligned box centred on centre
+	void box(vec2 centre, vec2 size, vec3 color);
+	void circle(vec2 centre, float radius, vec3 color, int segments = 16);
+	// joins the points in order
+	void path(const vec2 *points, size_t count, vec3 color);
+	void text(vec2 position, const std::string &content, vec3 color, float scale = 0.4f);
+
+	void clear();
+
+	// pairs of vertices, one line each
+	const std::vector<Vertex> &lines() const { return vertices; }
+	const std::vector<Label> &labels() const { return label_list; }
+
+private:
+	std::vector<Vertex> vertices;
+	std::vector<Label> label_list;
+};
+
+extern DebugDraw debug_draw;
@@ -0,0 +1,88 @@
+// internal
+#include "frame_arena.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+
+FrameArena frame_arena;
+
+FrameArena::~FrameArena()
+{
+	release();
+}
+
+void FrameArena::init(size_t capacity)
+{
+	release();
+	add_block(capacity);
+}
+
+void *FrameArena::allocate(size_t size, size_t align)
+{
+	assert(align != 0 && (align & (align - 1)) == 0);
+	if (blocks.empty())
+	{
+		init();
+	}
+
+	Block &block = blocks.back();
+	uintptr_t base = (uintptr_t)block.data;
+	size_t offset = ((base + used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+	if (offset + size > block.size)
+	{
+		// doesn't fit, start a new block big enough for it and keep the old one alive until the reset
+		add_block(std::max(block.size, size + align));
+		current.overflow_blocks += 1;
+		return allocate(size, align);
+	}
+
+	used = offset + size;
+	current.bytes += size;
+	current.allocations += 1;
+	return block.data + offset;
+}
+
+void FrameArena::reset()
+{
+	last = current;
+	current = Stats();
+
+	// the frame needed more than one block, replace them with a single one holding all of it for next time
+	if (blocks.size() > 1)
+	{
+		size_t total = capacity();
+		release();
+		add_block(total);
+	}
+	used = 0;
+}
+
+size_t FrameArena::capacity() const
+{
+	size_t total = 0;
+	for (const Block &block : blocks)
+	{
+		total += block.size;
+	}
+	return total;
+}
+
+void FrameArena::add_block(size_t size)
+{
+	Block block;
+	block.data = new uint8_t[size];
+	block.size = size;
+	blocks.push_back(block);
+	used = 0;
+}
+
+void FrameArena::release()
+{
+	for (Block &block : blocks)
+	{
+		delete[] block.data;
+	}
+	blocks.clear();
+	used = 0;
+}
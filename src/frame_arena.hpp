@@ -0,0 +1,79 @@
+#pragma once
+
+// stlib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bump allocator for scratch memory that only lives until the end of the frame (search queues, temporary lists)
+// Allocating is a pointer bump, nothing is freed on its own, everything is released at once by reset() after the frame is drawn
+// Runs out into extra blocks rather than failing, on reset those are merged into one block big enough for the whole frame
+// Main thread only, jobs running on the workers must not allocate from it
+class FrameArena
+{
+public:
+	static const size_t DEFAULT_CAPACITY = 256 * 1024;
+
+	// what the last finished frame used
+	struct Stats
+	{
+		size_t bytes = 0;
+		int allocations = 0;
+		// extra blocks the frame needed because the arena was too small
+		int overflow_blocks = 0;
+	};
+
+	~FrameArena();
+
+	void init(size_t capacity = DEFAULT_CAPACITY);
+	void *allocate(size_t size, size_t align);
+	void reset();
+
+	const Stats &last_frame() const { return last; }
+	size_t capacity() const;
+
+private:
+	struct Block
+	{
+		uint8_t *data = nullptr;
+		size_t size = 0;
+	};
+
+	void add_block(size_t size);
+	void release();
+
+	std::vector<Block> blocks;
+	// bump position inside the last block
+	size_t used = 0;
+
+	Stats current;
+	Stats last;
+};
+
+extern FrameArena frame_arena;
+
+// STL allocator handing out memory from the frame arena, deallocate does nothing since the arena is reset as a whole
+// Containers using it must not outlive the frame, copy anything that has to stay into a normal container
+template <typename T>
+struct FrameAllocator
+{
+	typedef T value_type;
+
+	FrameAllocator() {}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U> &) {}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(frame_arena.allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T> &, const FrameAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T> &, const FrameAllocator<U> &) { return false; }
+
+template <typename T>
+using frame_vector = std::vector<T, FrameAllocator<T>>;
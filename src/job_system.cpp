@@ -0,0 +1,310 @@
+// internal
+#include "job_system.hpp"
+
+#include <algorithm>
+
+JobSystem jobs;
+
+// index of the deque owned by the current thread (main thread is 0)
+static thread_local int worker_index = 0;
+
+bool WorkStealingDeque::push(Job *job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= CAPACITY)
+	{
+		return false;
+	}
+
+	buffer[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return true;
+}
+
+Job *WorkStealingDeque::pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+
+	if (t > b)
+	{
+		// empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job *job = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// last job, race any thieves for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job *WorkStealingDeque::steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+	{
+		return nullptr;
+	}
+
+	Job *job = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+bool SystemTask::conflicts_with(const SystemTask &other) const
+{
+	if (structural || other.structural)
+	{
+		return true;
+	}
+
+	for (const ContainerInterface *container : writes)
+	{
+		if (std::find(other.writes.begin(), other.writes.end(), container) != other.writes.end() ||
+			std::find(other.reads.begin(), other.reads.end(), container) != other.reads.end())
+		{
+			return true;
+		}
+	}
+	for (const ContainerInterface *container : other.writes)
+	{
+		if (std::find(reads.begin(), reads.end(), container) != reads.end())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void SystemSchedule::add(SystemTask system)
+{
+	// first wave after the last one holding a system it conflicts with
+	int wave = 0;
+	for (size_t i = 0; i < systems.size(); i++)
+	{
+		if (system.conflicts_with(systems[i]))
+		{
+			wave = std::max(wave, wave_of[i] + 1);
+		}
+	}
+
+	systems.push_back(std::move(system));
+	wave_of.push_back(wave);
+	wave_count = std::max(wave_count, wave + 1);
+}
+
+void JobSystem::init(int worker_count)
+{
+	if (running)
+	{
+		return;
+	}
+
+	if (worker_count < 0)
+	{
+		worker_count = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+	}
+
+	running = true;
+	worker_index = 0;
+	for (int i = 0; i <= worker_count; i++)
+	{
+		deques.push_back(new WorkStealingDeque());
+		pools.push_back(new JobPool());
+	}
+	for (int i = 1; i <= worker_count; i++)
+	{
+		workers.emplace_back(&JobSystem::worker_loop, this, i);
+	}
+}
+
+void JobSystem::shutdown()
+{
+	if (!running)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		running = false;
+	}
+	sleep_cv.notify_all();
+
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	workers.clear();
+
+	for (WorkStealingDeque *deque : deques)
+	{
+		delete deque;
+	}
+	deques.clear();
+	for (JobPool *pool : pools)
+	{
+		delete pool;
+	}
+	pools.clear();
+}
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+Job *JobSystem::acquire_job()
+{
+	if (pools.empty())
+	{
+		return nullptr;
+	}
+
+	// jobs are handed out in order and usually finish in order, the first one tried is almost always free
+	JobPool &pool = *pools[worker_index];
+	for (size_t i = 0; i < JobPool::SIZE; i++)
+	{
+		Job &job = pool.jobs[pool.next];
+		pool.next = (pool.next + 1) % JobPool::SIZE;
+		if (!job.in_use.load(std::memory_order_acquire))
+		{
+			job.in_use.store(true, std::memory_order_relaxed);
+			return &job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::enqueue(Job *job)
+{
+	// our deque is full, just do the work now
+	if (!deques[worker_index]->push(job))
+	{
+		execute(job);
+		return;
+	}
+
+	queued++;
+	// a worker going to sleep counts itself before it checks queued, so one of the two always sees the other
+	if (sleeping.load() > 0)
+	{
+		// taking the lock means the worker is either inside wait() already or will see queued when it checks
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		sleep_cv.notify_one();
+	}
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+	while (counter.pending.load() > 0)
+	{
+		// help out instead of blocking
+		if (!run_one(worker_index))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::run_systems(const SystemSchedule &schedule)
+{
+	for (int wave = 0; wave < schedule.wave_count; wave++)
+	{
+		JobCounter counter;
+		for (size_t i = 0; i < schedule.systems.size(); i++)
+		{
+			if (schedule.wave_of[i] == wave && !schedule.systems[i].main_thread)
+			{
+				// the schedule outlives the wave, no need to copy the system's function into the job
+				const SystemTask &system = schedule.systems[i];
+				submit([&system]()
+					   { system.run(); },
+					   counter);
+			}
+		}
+		// the workers pick up the rest of the wave meanwhile
+		for (size_t i = 0; i < schedule.systems.size(); i++)
+		{
+			if (schedule.wave_of[i] == wave && schedule.systems[i].main_thread)
+			{
+				schedule.systems[i].run();
+			}
+		}
+		wait(counter);
+	}
+}
+
+void JobSystem::worker_loop(int index)
+{
+	worker_index = index;
+
+	while (running)
+	{
+		if (run_one(index))
+		{
+			continue;
+		}
+
+		// sleep until a job is submitted or the pool shuts down, rather than polling
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleeping++;
+		sleep_cv.wait(lock, [this]()
+					  { return queued.load() > 0 || !running; });
+		sleeping--;
+	}
+}
+
+// Runs a job from our own deque, or steals one from another thread, returns false if there was nothing to do
+bool JobSystem::run_one(int index)
+{
+	if (deques.empty())
+	{
+		return false;
+	}
+
+	Job *job = deques[index]->pop();
+
+	for (size_t i = 1; job == nullptr && i < deques.size(); i++)
+	{
+		job = deques[(index + i) % deques.size()]->steal();
+	}
+
+	if (job == nullptr)
+	{
+		return false;
+	}
+
+	queued--;
+	execute(job);
+	return true;
+}
+
+void JobSystem::execute(Job *job)
+{
+	job->invoke(job->storage);
+	job->destroy(job->storage);
+	// the counter may be gone as soon as it reaches zero, the job itself lives in its pool
+	job->counter->pending--;
+	job->in_use.store(false, std::memory_order_release);
+}
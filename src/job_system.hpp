@@ -0,0 +1,193 @@
+#pragma once
+
+// stlib
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "tiny_ecs.hpp"
+
+// Counts the jobs that are still outstanding, wait on it to block until all of them are done
+struct JobCounter
+{
+	std::atomic<int> pending{0};
+};
+
+// A unit of work handed to the scheduler
+// The callable is stored in the job itself and jobs come from a fixed pool per thread, submitting never allocates
+struct Job
+{
+	static const size_t STORAGE_SIZE = 48;
+
+	alignas(std::max_align_t) unsigned char storage[STORAGE_SIZE];
+	void (*invoke)(void *storage) = nullptr;
+	void (*destroy)(void *storage) = nullptr;
+	JobCounter *counter = nullptr;
+	// set by the thread owning the pool when it hands the job out, cleared by whichever thread ran it
+	std::atomic<bool> in_use{false};
+};
+
+// Fixed size lock-free work stealing deque (Chase-Lev)
+// Only the owning thread pushes and pops at the bottom, any thread can steal from the top
+class WorkStealingDeque
+{
+public:
+	static const int64_t CAPACITY = 4096;
+
+	bool push(Job *job);
+	Job *pop();
+	Job *steal();
+
+private:
+	std::atomic<int64_t> top{0};
+	std::atomic<int64_t> bottom{0};
+	std::atomic<Job *> buffer[CAPACITY];
+};
+
+// Ring of jobs owned by one thread, only that thread hands them out
+struct JobPool
+{
+	static const size_t SIZE = WorkStealingDeque::CAPACITY;
+
+	Job jobs[SIZE];
+	size_t next = 0;
+};
+
+// A system that can be scheduled alongside others
+// Two systems may run at the same time only if neither writes a container the other touches
+struct SystemTask
+{
+	const char *name;
+	std::vector<const ContainerInterface *> reads;
+	std::vector<const ContainerInterface *> writes;
+	// creates or removes entities (or anything else that touches every container)
+	bool structural = false;
+	std::function<void()> run;
+	// runs on the thread calling run_systems, for systems using main thread only state (the frame arena)
+	bool main_thread = false;
+
+	bool conflicts_with(const SystemTask &other) const;
+};
+
+// A fixed list of systems, split into waves as they are added so nothing is worked out again per frame
+// Systems inside a wave don't conflict and run concurrently, conflicting systems keep the order they were added in
+struct SystemSchedule
+{
+	std::vector<SystemTask> systems;
+	std::vector<int> wave_of;
+	int wave_count = 0;
+
+	void add(SystemTask system);
+};
+
+// Fixed pool of worker threads, the main thread owns deque 0 and helps out while waiting
+// With no workers everything runs inline on the calling thread
+class JobSystem
+{
+public:
+	// worker_count < 0 uses one worker per hardware thread (minus the main thread)
+	void init(int worker_count = -1);
+	void shutdown();
+
+	// run is copied into the job, its captures have to fit in Job::STORAGE_SIZE
+	template <typename F>
+	void submit(F run, JobCounter &counter);
+	void wait(JobCounter &counter);
+
+	// Splits [0, count) into batches of at least min_batch and runs fn(begin, end) on each, returns once all are done
+	template <typename F>
+	void parallel_for(size_t count, size_t min_batch, const F &fn);
+
+	// Runs the schedule's waves one after the other, returns once every system is done
+	void run_systems(const SystemSchedule &schedule);
+
+	int thread_count() const { return (int)workers.size() + 1; }
+
+	~JobSystem();
+
+private:
+	void worker_loop(int index);
+	bool run_one(int index);
+	void execute(Job *job);
+
+	// next free job in the calling thread's pool, nullptr if there is no pool or all of its jobs are in flight
+	Job *acquire_job();
+	// queues the job on the calling thread's deque, runs it now if the deque is full
+	void enqueue(Job *job);
+
+	std::vector<std::thread> workers;
+	std::vector<WorkStealingDeque *> deques;
+	// one per deque, the main thread's is 0
+	std::vector<JobPool *> pools;
+
+	std::atomic<bool> running{false};
+	std::atomic<int> queued{0};
+	// workers blocked on sleep_cv, submit only takes the lock to wake one when there are any
+	std::atomic<int> sleeping{0};
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cv;
+};
+
+extern JobSystem jobs;
+
+template <typename F>
+void JobSystem::submit(F run, JobCounter &counter)
+{
+	static_assert(sizeof(F) <= Job::STORAGE_SIZE, "job captures too much, capture a reference to the data instead");
+	static_assert(alignof(F) <= alignof(std::max_align_t), "job captures need more than the default alignment");
+
+	counter.pending++;
+
+	Job *job = acquire_job();
+	if (job == nullptr)
+	{
+		// not initialized or every job of this thread is still in flight, just do the work now
+		run();
+		counter.pending--;
+		return;
+	}
+
+	new (job->storage) F(std::move(run));
+	job->invoke = [](void *storage)
+	{ (*static_cast<F *>(storage))(); };
+	job->destroy = [](void *storage)
+	{ static_cast<F *>(storage)->~F(); };
+	job->counter = &counter;
+	enqueue(job);
+}
+
+template <typename F>
+void JobSystem::parallel_for(size_t count, size_t min_batch, const F &fn)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	min_batch = std::max(min_batch, (size_t)1);
+
+	// a few batches per thread so faster threads can steal the leftovers
+	size_t batch = std::max(min_batch, count / (thread_count() * 4));
+	if (workers.empty() || batch >= count)
+	{
+		fn(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin = 0; begin < count; begin += batch)
+	{
+		size_t end = std::min(count, begin + batch);
+		submit([&fn, begin, end]()
+			   { fn(begin, end); },
+			   counter);
+	}
+	wait(counter);
+}
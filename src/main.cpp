@@ -11,6 +11,9 @@
 #include "world_system.hpp"
 #include "animation_system.hpp"
 #include "damage_indicator_system.hpp"
+#include "job_system.hpp"
+#include "frame_arena.hpp"
+#include "audio_system.hpp"
 
 using Clock = std::chrono::high_resolution_clock;
 
@@ -20,7 +23,7 @@ int main()
 	// Global systems
 	WorldSystem world;
 	RenderSystem renderer;
-	PhysicsSystem physics;
+	PhysicsSystem &physics = phsyics;
 	AnimationSystem animations;
 	DamageIndicatorSystem damages;
 
@@ -37,6 +40,57 @@ int main()
 	// initialize the main systems
 	renderer.init(window);
 	world.init(&renderer);
+	jobs.init();
+	frame_arena.init();
+
+	float elapsed_ms = 0.f;
+
+	// Systems declare the containers they read / write so the job system can overlap the independent ones
+	// Damage indicators only move their own clock on, they don't touch the registry
+	// Swarm members leaving the map are removed in a wave of their own once the others are done
+	// Path searches use the frame arena, so they run on the main thread while the workers take the rest of their wave
+	SystemTask animation_task = {"animation",
+								 {&registry.renderRequests},
+								 {&registry.animationSets, &registry.renderRequests},
+								 false,
+								 [&]()
+								 { animations.step(elapsed_ms); }};
+	SystemSchedule menu_systems;
+	menu_systems.add(animation_task);
+
+	SystemSchedule game_systems;
+	game_systems.add(animation_task);
+	game_systems.add({"damage indicators",
+					  {},
+					  {},
+					  false,
+					  [&]()
+					  { damages.step(elapsed_ms); }});
+	game_systems.add({"particles",
+					  {},
+					  {&registry.emitters},
+					  false,
+					  [&]()
+					  { physics.move_particles(elapsed_ms); }});
+	game_systems.add({"path requests",
+					  {&registry.deadlys, &registry.motions},
+					  {&registry.paths},
+					  false,
+					  [&]()
+					  { physics.process_path_requests(); },
+					  true});
+	game_systems.add({"swarms",
+					  {&registry.players, &registry.deathTimers},
+					  {&registry.motions, &registry.swarms},
+					  false,
+					  [&]()
+					  { physics.move_swarms(elapsed_ms); }});
+	game_systems.add({"swarm leavers",
+					  {},
+					  {},
+					  true,
+					  [&]()
+					  { physics.remove_swarm_leavers(); }});
 
 	// variable timestep loop
 	auto t = Clock::now();
@@ -47,7 +101,7 @@ int main()
 
 		// Calculating elapsed times in milliseconds from the previous iteration
 		auto now = Clock::now();
-		float elapsed_ms =
+		elapsed_ms =
 			(float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
 		t = now;
 
@@ -61,10 +115,8 @@ int main()
 				physics.step(elapsed_ms, world.get_current_map());
 				
 			}
-			animations.step(elapsed_ms);
-			if (screen.state == GameState::GAME) {
-				damages.step(elapsed_ms);
-			}
+
+			jobs.run_systems((screen.state == GameState::GAME) ? game_systems : menu_systems);
 			
 		}
 		else
@@ -85,7 +137,15 @@ int main()
 		}
 
 		renderer.draw();
+
+		// sounds requested this frame go to the audio thread as one batch
+		audio.end_frame();
+
+		// everything allocated from the frame arena this frame is dead now
+		frame_arena.reset();
 	}
 
+	jobs.shutdown();
+
 	return EXIT_SUCCESS;
 }
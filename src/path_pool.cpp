@@ -0,0 +1,139 @@
+// internal
+#include "path_pool.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+
+PathPool path_pool;
+
+PathHandle PathPool::write(Entity owner, const vec2 *points, size_t count)
+{
+	PathHandle handle;
+	auto it = handle_of.find(owner);
+	if (it != handle_of.end())
+	{
+		handle = it->second;
+	}
+	else if (!free_handles.empty())
+	{
+		handle = free_handles.back();
+		free_handles.pop_back();
+		spans[handle] = {owner, 0, 0, 0, true};
+		handle_of[owner] = handle;
+	}
+	else
+	{
+		handle = (PathHandle)spans.size();
+		spans.push_back({owner, 0, 0, 0, true});
+		handle_of[owner] = handle;
+	}
+
+	Span &span = spans[handle];
+	if (count > span.capacity)
+	{
+		// outgrew its span, move to a bigger one (the handle stays the same)
+		if (span.capacity > 0)
+		{
+			free_range(span.offset, span.capacity);
+		}
+		uint32_t span_class = size_class(count);
+		span.offset = allocate_range(span_class);
+		span.capacity = MIN_SPAN << span_class;
+	}
+
+	std::copy(points, points + count, slab.begin() + span.offset);
+	span.length = (uint32_t)count;
+	return handle;
+}
+
+void PathPool::release(PathHandle handle)
+{
+	if (handle >= spans.size() || !spans[handle].live)
+	{
+		return;
+	}
+
+	Span &span = spans[handle];
+	if (span.capacity > 0)
+	{
+		free_range(span.offset, span.capacity);
+	}
+	span.capacity = 0;
+	span.length = 0;
+	span.live = false;
+	handle_of.erase(span.owner);
+	free_handles.push_back(handle);
+}
+
+size_t PathPool::size(PathHandle handle) const
+{
+	if (handle >= spans.size() || !spans[handle].live)
+	{
+		return 0;
+	}
+	return spans[handle].length;
+}
+
+vec2 PathPool::at(PathHandle handle, size_t index) const
+{
+	assert(index < size(handle));
+	return slab[spans[handle].offset + index];
+}
+
+const vec2 *PathPool::data(PathHandle handle) const
+{
+	if (size(handle) == 0)
+	{
+		return nullptr;
+	}
+	return &slab[spans[handle].offset];
+}
+
+void PathPool::collect()
+{
+	for (PathHandle handle = 0; handle < spans.size(); handle++)
+	{
+		Span &span = spans[handle];
+		if (span.live && !registry.paths.has(span.owner) && !registry.tenants.has(span.owner))
+		{
+			release(handle);
+		}
+	}
+}
+
+uint32_t PathPool::size_class(size_t count)
+{
+	uint32_t span_class = 0;
+	while ((size_t)(MIN_SPAN << span_class) < count)
+	{
+		span_class++;
+	}
+	return span_class;
+}
+
+uint32_t PathPool::allocate_range(uint32_t span_class)
+{
+	if (span_class < free_ranges.size() && !free_ranges[span_class].empty())
+	{
+		uint32_t offset = free_ranges[span_class].back();
+		free_ranges[span_class].pop_back();
+		return offset;
+	}
+
+	// nothing free of that size, grow the slab (spans only store offsets so nothing has to be fixed up)
+	uint32_t offset = (uint32_t)slab.size();
+	slab.resize(slab.size() + (MIN_SPAN << span_class));
+	return offset;
+}
+
+void PathPool::free_range(uint32_t offset, uint32_t capacity)
+{
+	uint32_t span_class = size_class(capacity);
+	if (span_class >= free_ranges.size())
+	{
+		free_ranges.resize(span_class + 1);
+	}
+	free_ranges[span_class].push_back(offset);
+}
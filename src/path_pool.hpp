@@ -0,0 +1,58 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "common.hpp"
+#include "components.hpp"
+#include "tiny_ecs.hpp"
+
+// Shared storage for the waypoints of every path an entity follows (enemy Path components, tenants)
+// Points live in one slab cut into power of two sized spans, a handle names a span and stays valid while its span moves or grows
+// Each owner has at most one span, writing a new path for it overwrites the old one in place when it fits
+// Spans whose owner no longer has a Path or Tenant component are handed back by collect()
+class PathPool
+{
+public:
+	static const uint32_t MIN_SPAN = 16;
+
+	// Stores count points as the owner's path, returns the owner's handle (the same one every time)
+	PathHandle write(Entity owner, const vec2 *points, size_t count);
+	void release(PathHandle handle);
+
+	// 0 for INVALID_PATH, so components that never got a path read as empty
+	size_t size(PathHandle handle) const;
+	vec2 at(PathHandle handle, size_t index) const;
+	// the size(handle) points in order, only valid until the next write
+	const vec2 *data(PathHandle handle) const;
+
+	// Releases the spans of owners that died or lost their path component
+	void collect();
+
+	size_t live_count() const { return handle_of.size(); }
+
+private:
+	struct Span
+	{
+		Entity owner;
+		uint32_t offset;
+		uint32_t capacity;
+		uint32_t length;
+		bool live;
+	};
+
+	static uint32_t size_class(size_t count);
+	uint32_t allocate_range(uint32_t size_class);
+	void free_range(uint32_t offset, uint32_t capacity);
+
+	std::vector<vec2> slab;
+	std::vector<Span> spans;
+	std::vector<PathHandle> free_handles;
+	// free slab ranges, indexed by size class (capacity MIN_SPAN << class)
+	std::vector<std::vector<uint32_t>> free_ranges;
+	std::unordered_map<unsigned int, PathHandle> handle_of;
+};
+
+extern PathPool path_pool;
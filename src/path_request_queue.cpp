@@ -0,0 +1,116 @@
+// internal
+#include "path_request_queue.hpp"
+#include "physics_system.hpp"
+#include "raycast_system.hpp"
+#include "path_pool.hpp"
+
+#include <chrono>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static uint64_t request_key(vec2 start, vec2 goal)
+{
+	ivec2 start_tile = world_to_tile(start);
+	ivec2 goal_tile = world_to_tile(goal);
+	return ((uint64_t)(start_tile.x & 0xFFFF)) |
+		   ((uint64_t)(start_tile.y & 0xFFFF) << 16) |
+		   ((uint64_t)(goal_tile.x & 0xFFFF) << 32) |
+		   ((uint64_t)(goal_tile.y & 0xFFFF) << 48);
+}
+
+void PathRequestQueue::submit(Entity enemy, vec2 start, vec2 goal)
+{
+	if (is_pending(enemy))
+	{
+		return;
+	}
+	pending.insert(enemy);
+
+	uint64_t key = request_key(start, goal);
+	auto it = requests.find(key);
+	if (it != requests.end())
+	{
+		it->second.waiting.push_back(enemy);
+		return;
+	}
+
+	requests[key] = {start, goal, {enemy}};
+	order.push_back(key);
+}
+
+bool PathRequestQueue::is_pending(Entity enemy) const
+{
+	return pending.count(enemy) > 0;
+}
+
+void PathRequestQueue::process(float budget_us)
+{
+	auto start_time = Clock::now();
+
+	while (!order.empty())
+	{
+		uint64_t key = order.front();
+		order.pop_front();
+		PathRequest request = std::move(requests[key]);
+		requests.erase(key);
+
+		Motion start_motion;
+		start_motion.position = request.start;
+		Motion goal_motion;
+		goal_motion.position = request.goal;
+
+		deliver(request, find_path(start_motion, goal_motion));
+
+		float elapsed_us = (float)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time).count();
+		if (elapsed_us >= budget_us)
+		{
+			break;
+		}
+	}
+}
+
+void PathRequestQueue::deliver(const PathRequest &request, const frame_vector<vec2> &points)
+{
+	for (Entity enemy : request.waiting)
+	{
+		pending.erase(enemy);
+
+		// enemy died while waiting, or no path was found (keep the old one)
+		if (!registry.deadlys.has(enemy) || !registry.motions.has(enemy) || points.empty())
+		{
+			continue;
+		}
+
+		// the enemy kept moving while it waited, pick up the new path from where it is now if it's on it
+		const Motion &motion = registry.motions.get(enemy);
+		size_t cursor = 0;
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (distance(points[i], motion.position) < 1.f)
+			{
+				cursor = i;
+				break;
+			}
+		}
+
+		// the enemy's old path storage is overwritten in place
+		PathHandle handle = path_pool.write(enemy, points.data(), points.size());
+		if (registry.paths.has(enemy))
+		{
+			Path &path = registry.paths.get(enemy);
+			path.points = handle;
+			path.current_index = cursor;
+		}
+		else
+		{
+			registry.paths.emplace(enemy, Path{handle, cursor});
+		}
+	}
+}
+
+void PathRequestQueue::clear()
+{
+	order.clear();
+	requests.clear();
+	pending.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// stlib
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common.hpp"
+#include "frame_arena.hpp"
+#include "tiny_ecs.hpp"
+
+// Pathfinding requests that are waiting for a time slice
+// Enemies keep following their old path until the new one is handed to them
+class PathRequestQueue
+{
+public:
+	// Queues a path from start to goal for the enemy
+	// Requests starting on the same tile and heading to the same tile share one search
+	void submit(Entity enemy, vec2 start, vec2 goal);
+
+	bool is_pending(Entity enemy) const;
+
+	// Runs queued searches until budget_us microseconds have passed (always at least one) and hands out the results
+	void process(float budget_us);
+
+	void clear();
+	size_t size() const { return order.size(); }
+
+private:
+	struct PathRequest
+	{
+		vec2 start;
+		vec2 goal;
+		std::vector<Entity> waiting;
+	};
+
+	void deliver(const PathRequest &request, const frame_vector<vec2> &points);
+
+	// requests in the order they were made, keyed on (start tile, goal tile)
+	std::deque<uint64_t> order;
+	std::unordered_map<uint64_t, PathRequest> requests;
+	std::unordered_set<unsigned int> pending;
+};
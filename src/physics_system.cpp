@@ -2,19 +2,27 @@
 #include "physics_system.hpp"
 #include "world_init.hpp"
 #include "world_system.hpp"
+#include "raycast_system.hpp"
+#include "job_system.hpp"
+#include "continuous_collision.hpp"
+#include "frame_arena.hpp"
+#include "path_pool.hpp"
+#include "ai_lod.hpp"
+#include "solid_grid.hpp"
 
-WorldSystem world;
 PhysicsSystem phsyics;
 std::vector<std::vector<int>> map;
-const int TILE_SIZE = 100;
-const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE));
-const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE));
+// time each frame may spend on queued enemy pathfinding
+const float PATH_REQUEST_BUDGET_US = 1500.f;
+// how far a swept projectile is pushed into the solid it hit so the overlap test catches it
+const float PROJECTILE_EMBED_DEPTH = 1.f;
 
 // C++ random number generator
 std::default_random_engine rng;
 std::uniform_real_distribution<float> uniform_dist; // number between 0..1
 
 #include <iostream>
+#include <new>
 
 // Returns the local bounding coordinates (AABB)
 vec2 get_bounding_box(const Motion &motion)
@@ -228,6 +236,97 @@ bool mesh_collides(const Entity &mesh_entity, const Motion &mesh_motion, const M
     return false;
 }
 
+// Records the kinds of contact entity has with other that the world reacts to (if any)
+void classify_collision(Entity entity, Entity other)
+{
+    auto& collisions = registry.collisions;
+
+    if (registry.players.has(entity)) {
+        if (registry.deadlys.has(other) || registry.spikes.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PLAYER_ENEMY, entity, other});
+        } else if (registry.eatables.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PLAYER_COLLECTIBLE, entity, other});
+        }
+        if (registry.stickies.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PLAYER_STICKY, entity, other});
+        }
+        if (registry.holdInteracts.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PLAYER_INTERACT, entity, other});
+        }
+        if (registry.doors.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PLAYER_DOOR, entity, other});
+        }
+    } else if (registry.deadlys.has(entity)) {
+        if (registry.projectiles.has(entity) && registry.solidObjs.has(other)) {
+            collisions.push_back({COLLISION_TYPE::PROJECTILE_SOLID, entity, other});
+        }
+    } else if (registry.playerAttacks.has(entity)) {
+        if (registry.deadlys.has(other)) {
+            collisions.push_back({COLLISION_TYPE::ATTACK_ENEMY, entity, other});
+        }
+    }
+}
+
+// Collision events are recorded once per pair (from whichever side they matter)
+void record_collision(Entity entity_i, Entity entity_j)
+{
+    classify_collision(entity_i, entity_j);
+    classify_collision(entity_j, entity_i);
+}
+
+// A collider that can move, gathered once per step for the pairwise test
+struct DynamicCollider
+{
+    Entity entity;
+    Motion *motion;
+    COLLISION_LAYER layer;
+    Rest *rest;
+};
+
+// Steps a moving collider has to stay still, touching no other moving collider, before it sleeps
+const int SLEEP_AFTER_STEPS = 30;
+
+// Records a collision between two colliders whose layers interact if their boxes (or the sticky mesh / the enemy hitbox) overlap
+// Returns true if the boxes overlap, even when the finer test then finds no contact
+bool test_collider_pair(Entity entity_i, const Motion &motion_i, COLLISION_LAYER layer_i, Entity entity_j, const Motion &motion_j, COLLISION_LAYER layer_j)
+{
+    if (collides(motion_i, motion_j))
+    {
+        bool is_colliding = true;
+
+        // mesh-based collision between the player and sticky patches
+        if (registry.stickies.has(entity_i) && layer_j == COLLISION_LAYER::PLAYER)
+        {
+            is_colliding = mesh_collides(entity_i, motion_i, motion_j);
+        }
+        else if (registry.stickies.has(entity_j) && layer_i == COLLISION_LAYER::PLAYER)
+        {
+            is_colliding = mesh_collides(entity_j, motion_j, motion_i);
+        }
+
+        if (is_colliding)
+        {
+            bool player_vs_deadly = (layer_i == COLLISION_LAYER::PLAYER && (layer_j == COLLISION_LAYER::ENEMY || layer_j == COLLISION_LAYER::PROJECTILE)) ||
+                                    (layer_j == COLLISION_LAYER::PLAYER && (layer_i == COLLISION_LAYER::ENEMY || layer_i == COLLISION_LAYER::PROJECTILE));
+            if (player_vs_deadly) {
+                if (enemy_player_collides(motion_i, motion_j)) {
+                    record_collision(entity_i, entity_j);
+                }
+            } else {
+                // Create a collisions event
+                record_collision(entity_i, entity_j);
+            }
+        }
+        return true;
+    }
+    else
+    {
+        if (layer_i == COLLISION_LAYER::PLAYER)
+            registry.players.get(entity_i).last_pos = motion_i.position;
+        return false;
+    }
+}
+
 // Node in A* path
 struct Node
 {
@@ -245,6 +344,12 @@ struct Node
     }
 };
 
+// Search nodes live in the frame arena, they are never deleted one by one
+Node *new_frame_node(vec2 pos)
+{
+    return new (frame_arena.allocate(sizeof(Node), alignof(Node))) Node(pos);
+}
+
 // Calculate h cost using diagonal distance
 float calculate_h_cost(const vec2 &start, const vec2 &goal)
 {
@@ -257,19 +362,18 @@ float calculate_h_cost(const vec2 &start, const vec2 &goal)
 // Check if a certain tile can be moved onto by an enemy
 bool is_walkable(const vec2 &pos, vec2 dir)
 {
-    const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE));
-    const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE));
-
     // Convert to grid coordinates
-    int grid_x = static_cast<int>((pos.x - GRID_OFFSET_X) / TILE_SIZE);
-    int grid_y = static_cast<int>((pos.y - GRID_OFFSET_Y) / TILE_SIZE);
+    ivec2 tile = world_to_tile(pos);
+    int grid_x = tile.x;
+    int grid_y = tile.y;
 
     // Boundary check
     if (grid_x < 0 || grid_y < 0 || grid_y >= map.size() || grid_x >= map[0].size())
     {
         return false;
     }
-    const std::vector<vec2> diagonals = {
+    // static, this runs for every neighbour A* expands and a local vector was a heap allocation each time
+    static const vec2 diagonals[] = {
         {TILE_SIZE, TILE_SIZE}, {-TILE_SIZE, TILE_SIZE}, {TILE_SIZE, -TILE_SIZE}, {-TILE_SIZE, -TILE_SIZE}};
 
     // Check for clipping through walls when moving diagonally
@@ -294,168 +398,35 @@ bool is_walkable(const vec2 &pos, vec2 dir)
         if ((map[grid_y][grid_x + 1] >= 20 && map[grid_y + 1][grid_x] <= 38) || (map[grid_y][grid_x + 1] >= 20 && map[grid_y][grid_x + 1] <= 38)) return false;
     }
 
-    return map[grid_y][grid_x] == 1 || (map[grid_y][grid_x] >= 3 && map[grid_y][grid_x] <= 8) || map[grid_y][grid_x] > 38;
+    return tile_walkable(map[grid_y][grid_x]);
 }
 
-//strictly for checking map tile integers
-bool is_tile_walkable(int x, int y) {
-    if (y < 0 || x < 0 || y >= map.size() || x >= map[0].size()) {
-        return false;
-    }
-    return map[y][x] == 1 || (map[y][x] >= 3 && map[y][x] <= 8) || map[y][x] > 38;
-};
-
-// Checking for line of sight using Bresenham's algorithm
-// adapted to use a TILE_SIZE approximation instead of a pixel based line approximation
+// Line of sight checks are answered by the raycast system (bit-packed grid + per-frame memo)
 bool PhysicsSystem::has_los(const vec2 &start, const vec2 &end)
 {
-    const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE));
-    const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE));
-
-    // Convert to grid coordinates
-    int x1 = static_cast<int>((start.x - GRID_OFFSET_X) / TILE_SIZE);
-    int y1 = static_cast<int>((start.y - GRID_OFFSET_Y) / TILE_SIZE);
-    int x2 = static_cast<int>((end.x - GRID_OFFSET_X) / TILE_SIZE);
-    int y2 = static_cast<int>((end.y - GRID_OFFSET_Y) / TILE_SIZE);
-
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
-    int x = x1;
-    int y = y1;
-
-    // Determine step direction
-    int x_step = (x1 < x2) ? 1 : -1;
-    int y_step = (y1 < y2) ? 1 : -1;
-
-    int err;
-
-    // Choose which axis to move along
-    if (dx > dy)
-    {
-        err = dx / 2;
-        while (x != x2)
-        {
-            if (!is_tile_walkable(x, y)) {
-                return false;
-            }
-
-            err -= dy;
-            if (err < 0)
-            {
-                y += y_step;
-                err += dx;
-            }
-            x += x_step;
-        }
-    }
-    else
-    {
-        err = dy / 2;
-        while (y != y2)
-        {
-            if (!is_tile_walkable(x, y)) {
-                return false;
-            }
-
-            err -= dx;
-            if (err < 0)
-            {
-                x += x_step;
-                err += dy;
-            }
-            y += y_step;
-        }
-    }
-
-    if (y < 0 || x < 0 || y >= map.size() || x >= map[0].size())
-    {
-        return false;
-    }
-    return map[y][x] == 1 || (map[y][x] >= 3 && map[y][x] <= 8) || map[y][x] > 38;
+    return raycaster.has_los(start, end);
 }
 
-// Checking for dashing line of sight using Bresenham's algorithm
-// adapted to use a TILE_SIZE approximation instead of a pixel based line approximation
-bool has_dashing_los(const vec2& start, const vec2& end)
+// Dashing line of sight also requires the tiles beside the ray to be clear
+bool PhysicsSystem::has_dashing_los(const vec2 &start, const vec2 &end)
 {
-    const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE));
-    const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE));
-
-    // Convert to grid coordinates
-    int x1 = static_cast<int>((start.x - GRID_OFFSET_X) / TILE_SIZE);
-    int y1 = static_cast<int>((start.y - GRID_OFFSET_Y) / TILE_SIZE);
-    int x2 = static_cast<int>((end.x - GRID_OFFSET_X) / TILE_SIZE);
-    int y2 = static_cast<int>((end.y - GRID_OFFSET_Y) / TILE_SIZE);
-
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
-    int x = x1;
-    int y = y1;
-
-    // Determine step direction
-    int x_step = (x1 < x2) ? 1 : -1;
-    int y_step = (y1 < y2) ? 1 : -1;
-
-    int err;
-
-    // Choose which axis to move along
-    if (dx > dy)
-    {
-        err = dx / 2;
-        while (x != x2)
-        {
-            // Check current tile and adjacent tiles (above and below)
-            if (!is_tile_walkable(x, y) || !is_tile_walkable(x, y + 1) || !is_tile_walkable(x, y - 1)) {
-                return false;
-            }
-
-            err -= dy;
-            if (err < 0)
-            {
-                y += y_step;
-                err += dx;
-            }
-            x += x_step;
-        }
-    }
-    else
-    {
-        err = dy / 2;
-        while (y != y2)
-        {
-            // Check current tile and adjacent tiles (left and right)
-            if (!is_tile_walkable(x, y) || !is_tile_walkable(x + 1, y) || !is_tile_walkable(x - 1, y)) {
-                return false;
-            }
-
-            err -= dx;
-            if (err < 0)
-            {
-                x += x_step;
-                err += dy;
-            }
-            y += y_step;
-        }
-    }
-
-    return is_tile_walkable(x, y);
+    return raycaster.has_dashing_los(start, end);
 }
 
 // Find A* path for enemy
-std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
+frame_vector<vec2> find_path(const Motion &enemy, const Motion &player)
 {
     vec2 start = enemy.position;
 
 
-    // Convert to grid coordinates
-    int grid_x = static_cast<int>((player.position.x - GRID_OFFSET_X) / TILE_SIZE);
-    int grid_y = static_cast<int>((player.position.y - GRID_OFFSET_Y) / TILE_SIZE);
-    vec2 goal = {(640 - (25 * 100)) + (grid_x * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (grid_y * TILE_SIZE) + (TILE_SIZE / 2)};
+    // centre of the tile the player is on
+    vec2 goal = tile_centre(world_to_tile(player.position));
 
-    std::vector<Node *> open_list;
-    std::vector<Node *> closed_list;
+    // the search state is thrown away once the path is built, so it all comes from the frame arena
+    frame_vector<Node *> open_list;
+    frame_vector<Node *> closed_list;
 
-    Node *start_node = new Node(start);
+    Node *start_node = new_frame_node(start);
     start_node->h_cost = calculate_h_cost(start, goal);
     start_node->f_cost = start_node->h_cost;
 
@@ -464,7 +435,7 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
     while (!open_list.empty())
     {
         
-        std::vector<Node*>::iterator current_it;
+        frame_vector<Node*>::iterator current_it;
         if (open_list.size() < size_t(3)) {
             // Find node with lowest f_cost
             current_it = std::min_element(open_list.begin(), open_list.end(),
@@ -486,7 +457,7 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
         const float GOAL_THRESHOLD = TILE_SIZE * 0.5f;
         if (calculate_h_cost(current->position, goal) < GOAL_THRESHOLD)
         {
-            std::vector<vec2> path;
+            frame_vector<vec2> path;
             Node *current_path = current;
             while (current_path != nullptr)
             {
@@ -494,11 +465,6 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
                 current_path = current_path->parent;
             }
 
-            for (auto node : open_list)
-                delete node;
-            for (auto node : closed_list)
-                delete node;
-
             std::reverse(path.begin(), path.end());
             return path;
         }
@@ -507,7 +473,7 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
         closed_list.push_back(current);
 
         // Generate neighboring positions: 4 cardinal directions and 4 diagonal directions
-        const std::vector<vec2> directions = {
+        static const vec2 directions[] = {
             {TILE_SIZE, 0}, {-TILE_SIZE, 0}, {0, TILE_SIZE}, {0, -TILE_SIZE}, {TILE_SIZE, TILE_SIZE}, {-TILE_SIZE, TILE_SIZE}, {TILE_SIZE, -TILE_SIZE}, {-TILE_SIZE, -TILE_SIZE}};
 
         // Check if each direction is walkable
@@ -520,14 +486,13 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
             if (!is_walkable(neighbor_pos, dir))
                 continue;
 
-            Node *neighbor = new Node(neighbor_pos);
+            Node *neighbor = new_frame_node(neighbor_pos);
 
             // Skip if in closed list
             if (std::find_if(closed_list.begin(), closed_list.end(),
                              [&](const Node *n)
                              { return *n == *neighbor; }) != closed_list.end())
             {
-                delete neighbor;
                 continue;
             }
 
@@ -552,7 +517,6 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
 
             if (existing != open_list.end() && g_cost >= (*existing)->g_cost)
             {
-                delete neighbor;
                 continue;
             }
 
@@ -563,7 +527,6 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
 
             if (existing != open_list.end())
             {
-                delete *existing;
                 *existing = neighbor;
             }
             else
@@ -573,11 +536,7 @@ std::vector<vec2> find_path(const Motion &enemy, const Motion &player)
         }
     }
 
-    for (auto node : open_list)
-        delete node;
-    for (auto node : closed_list)
-        delete node;
-    return std::vector<vec2>();
+    return frame_vector<vec2>();
 }
 
 void PhysicsSystem::update_swarm_movement(Entity swarm_member, float step_seconds) {
@@ -695,25 +654,16 @@ void PhysicsSystem::update_swarm_movement(Entity swarm_member, float step_second
         entity_motion.velocity = normalize(entity_motion.velocity);
     }
     entity_motion.position = (entity_motion.speed * entity_motion.velocity * step_seconds) + entity_motion.position;
-    int grid_x = static_cast<int>((entity_motion.position.x - GRID_OFFSET_X) / TILE_SIZE);
-    int grid_y = static_cast<int>((entity_motion.position.y - GRID_OFFSET_Y) / TILE_SIZE);
+    ivec2 tile = world_to_tile(entity_motion.position);
 
-    if (grid_x > map[0].size() || grid_y > map.size() || grid_x < 0 || grid_y < 0) {
-        registry.remove_all_components_of(swarm_member);
-    } else if (map[grid_y][grid_x] == 0 || map[grid_y][grid_x] == 2) {
-        registry.remove_all_components_of(swarm_member);
+    // removed once every member has moved, the swarm update can run alongside other systems
+    if (tile.x >= (int)map[0].size() || tile.y >= (int)map.size() || tile.x < 0 || tile.y < 0) {
+        swarm_leavers.push_back(swarm_member);
+    } else if (map[tile.y][tile.x] == 0 || map[tile.y][tile.x] == 2) {
+        swarm_leavers.push_back(swarm_member);
     }
 }
 
-vec2 map_to_world(vec2 map_pos) {
-    return {-1860 + (map_pos.x * TILE_SIZE) + (TILE_SIZE / 2), -3760 + (map_pos.y * TILE_SIZE) + (TILE_SIZE / 2)};
-}
-
-vec2 world_to_map(vec2 world_pos) {
-    vec2 world_origin = {-1860, -3760};
-    return vec2((int)((world_pos.x - world_origin.x) - ((int)abs(world_pos.x - world_origin.x) % TILE_SIZE)) / TILE_SIZE, (int)((world_pos.y - world_origin.y) - ((int)abs(world_pos.y - world_origin.y) % TILE_SIZE)) / TILE_SIZE);
-}
-
 // A* pathfinding code
 //--------------------
 //  1. Calculate path for enemy based on tilemap coordinates
@@ -738,47 +688,8 @@ void PhysicsSystem::update_enemy_movement(Entity enemy, float step_seconds)
 
             vec2 knockback_velocity = knockback.force * knockback.dir * (1 / knockback.time_elapsed_ms) * step_seconds;
 
-            // Collision detection - copied from step function player x solid obj (should make into a function soon)
-
-            // check if new x value will collide with any solid objects
-            float new_x = motion.position[0] + (knockback_velocity[0]);
-            Motion new_motion_x = {{new_x, motion.position.y}, motion.angle, knockback_velocity, motion.scale, motion.speed};
-            for (Entity solid : registry.solidObjs.entities) {
-                Motion& motion_solid = registry.motions.get(solid);
-
-                // just trying to make it so we're not checking for collision on every single solid object in the scene
-                if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
-                    continue;
-                }
-
-                if (collides(motion_solid, new_motion_x)) {
-                    knockback_velocity.x = 0;
-                    break;
-                }
-            }
-
-            // update x value
-            motion.position[0] += knockback_velocity[0];
-
-            // check if new y value will collide with any solid objects
-            float new_y = motion.position[1] + (knockback_velocity[1]);
-            Motion new_motion_y = {{motion.position.x, new_y}, motion.angle, knockback_velocity, motion.scale, motion.speed};
-            for (Entity solid : registry.solidObjs.entities) {
-                Motion& motion_solid = registry.motions.get(solid);
-
-                // just trying to make it so we're not checking for collision on every single solid object in the scene
-                if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
-                    continue;
-                }
-
-                if (collides(motion_solid, new_motion_y)) {
-                    knockback_velocity.y = 0;
-                    break;
-                }
-            }
-
-            // update y value
-            motion.position[1] += knockback_velocity[1];
+            // swept against the solids so a big knockback (or a long frame) can't push the enemy through a wall
+            move_and_slide(motion, knockback_velocity);
             return;
         } else {
             registry.deadlys.get(enemy).state = ENEMY_STATE::IDLE;
@@ -795,14 +706,8 @@ void PhysicsSystem::update_enemy_movement(Entity enemy, float step_seconds)
  
     timer.timer += step_seconds;
 
-    const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE)) - TILE_SIZE / 2;
-    const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE)) - TILE_SIZE / 2;
-
-    // Convert to grid coordinates
-    int grid_x = static_cast<int>((motion.position.x - GRID_OFFSET_X) / TILE_SIZE);
-    int grid_y = static_cast<int>((motion.position.y - GRID_OFFSET_Y) / TILE_SIZE);
-    float raw_x = (motion.position.x - GRID_OFFSET_X) / TILE_SIZE;
-    float raw_y = (motion.position.y - GRID_OFFSET_Y) / TILE_SIZE;
+    // enemies only re-path from the exact centre of a tile, where their tile-bound movement stops
+    bool at_tile_centre = (motion.position == tile_centre(world_to_tile(motion.position)));
 
     // Recalculate path if all below are true:
     // - update time has elapsed
@@ -810,26 +715,12 @@ void PhysicsSystem::update_enemy_movement(Entity enemy, float step_seconds)
     // - the enemy has line of sight of the player
     // - OR of enemy was knocked back recently
     if (((!registry.paths.has(enemy) || timer.timer >= PATH_UPDATE_TIME) &&
-        (grid_x == raw_x && grid_y == raw_y) &&
+        at_tile_centre &&
         phsyics.has_los(motion.position, player_motion.position)) || knocked_back)
     {
-        // adjust pathfinding coordinates if knocked back recently
-        if ((grid_x != raw_x || grid_y != raw_y)) {
-            motion.position = registry.deadlys.get(enemy).knocked_back_pos;
-            timer.timer = 0.f;
-        }
-
-        std::vector<vec2> new_path = find_path(motion, player_motion);
-
-        if (!new_path.empty())
-        {
-            if (registry.paths.has(enemy))
-            {
-                registry.paths.remove(enemy);
-            }
-            registry.paths.emplace(enemy, Path{new_path, 0});
-            timer.timer = 0.f;
-        }
+        // keep following the current path until the queued search hands over a new one
+        path_requests.submit(enemy, motion.position, player_motion.position);
+        timer.timer = 0.f;
     }
 
     if (phsyics.has_los(motion.position, player_motion.position)) {
@@ -842,9 +733,10 @@ void PhysicsSystem::update_enemy_movement(Entity enemy, float step_seconds)
     if (registry.paths.has(enemy) && registry.deadlys.get(enemy).state != ENEMY_STATE::ATTACK)
     {
         Path &path = registry.paths.get(enemy);
-        if (path.points.size() > 1 && path.current_index < path.points.size() - 1)
+        size_t path_size = path_pool.size(path.points);
+        if (path_size > 1 && path.current_index < path_size - 1)
         {
-            vec2 target = path.points[path.current_index + 1];
+            vec2 target = path_pool.at(path.points, path.current_index + 1);
             vec2 direction = {
                 target.x - motion.position.x,
                 target.y - motion.position.y};
@@ -935,103 +827,349 @@ void PhysicsSystem::update_boss_movement(Entity enemy, float step_seconds) {
 
     // TODO: eventually merge this movement stuff with the player movement bc its the same code
 
-    // check if new x value will collide with any solid objects
-    float new_x = motion.position[0] + (motion.velocity[0] * step_seconds);
-    Motion new_motion_x = {{new_x, motion.position.y}, motion.angle, motion.velocity, motion.scale, motion.speed};
-    for (Entity solid : registry.solidObjs.entities) {
-        Motion& motion_solid = registry.motions.get(solid);
+    // stop at any solid objects in the way and slide along them
+    bvec2 blocked = move_and_slide(motion, motion.velocity * step_seconds);
+    if (blocked.x) {
+        motion.velocity.x = 0;
+    }
+    if (blocked.y) {
+        motion.velocity.y = 0;
+    }
+}
 
-        // trying to make it so we're not checking for collision on every single solid object in the scene
-        if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
-            continue;
+void PhysicsSystem::move_players(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    for (Entity entity : registry.players.entities) {
+        Motion& motion = registry.motions.get(entity);
+        auto& player = registry.players.get(entity);
+        // Updating speed to make sure most recent value is applied to motion
+        if (distance({0, 0}, motion.velocity) != 0) {
+            motion.velocity = (1 / distance({0, 0}, motion.velocity)) * motion.velocity;
         }
 
-        if (collides(motion_solid, new_motion_x)) {
+        float temp_multiplier = 1.f;
+        if (registry.powerups.has(entity)) {
+            Powerup& powerup = registry.powerups.get(entity);
+            if (powerup.type == PowerupType::SPEED_BOOST && (player.is_dash_up || (!player.is_dash_up && (player.curr_dash_cooldown_ms < (player.dash_cooldown_ms - player.dash_time))))) {
+                temp_multiplier *= powerup.multiplier;
+            }
+        }
+        
+        if (player.slowed_duration_ms <= 0.f) {
+            motion.velocity = motion.speed * temp_multiplier * motion.velocity;
+        }
+        else {
+            motion.velocity = motion.speed * motion.velocity * temp_multiplier * player.slowed_amount;
+        }
+
+        // PLAYER x SOLID COLLISION HANDLING
+
+        // swept so dashes stop at the wall instead of skipping over it on long frames
+        bvec2 blocked = move_and_slide(motion, motion.velocity * step_seconds);
+        if (blocked.x) {
             motion.velocity.x = 0;
-            break;
+        }
+        if (blocked.y) {
+            motion.velocity.y = 0;
         }
     }
+}
 
-    // update x value
-    motion.position[0] += motion.velocity[0] * step_seconds;
+void PhysicsSystem::move_chasers(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    ComponentContainer<Chaser> &chasers = registry.chasers;
+    for (uint i = 0; i < chasers.size(); i++) {
+        Entity entity = chasers.entities[i];
+        // dying enemies stay where they are
+        if (registry.deathTimers.has(entity)) {
+            continue;
+        }
 
-    // check if new y value will collide with any solid objects
-    float new_y = motion.position[1] + (motion.velocity[1] * step_seconds);
-    Motion new_motion_y = {{motion.position.x, new_y}, motion.angle, motion.velocity, motion.scale, motion.speed};
-    for (Entity solid : registry.solidObjs.entities) {
-        Motion& motion_solid = registry.motions.get(solid);
+        Chaser& chaser = chasers.components[i];
+        chaser.pending_seconds += step_seconds;
+        if (ai_lod.update_due(entity, registry.motions.get(entity).position)) {
+            update_enemy_movement(entity, chaser.pending_seconds);
+            chaser.pending_seconds = 0.f;
+        }
+    }
+}
 
-        // trying to make it so we're not checking for collision on every single solid object in the scene
-        if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
+void PhysicsSystem::move_swarms(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    for (Entity entity : registry.swarms.entities) {
+        if (!registry.deathTimers.has(entity)) {
+            update_swarm_movement(entity, step_seconds);
+        }
+    }
+}
+
+void PhysicsSystem::remove_swarm_leavers()
+{
+    for (Entity entity : swarm_leavers) {
+        registry.remove_all_components_of(entity);
+    }
+    swarm_leavers.clear();
+}
+
+void PhysicsSystem::process_path_requests()
+{
+    // Work through queued enemy path searches, spreading bursts of requests over several frames
+    path_requests.process(PATH_REQUEST_BUDGET_US);
+}
+
+void PhysicsSystem::move_particles(float elapsed_ms)
+{
+    // emitters don't share particles, so each one can be moved on a different worker
+    // an emitter only holds a few dozen particles, smaller batches cost more to hand out than to run
+    auto& emitter_registry = registry.emitters;
+    jobs.parallel_for(emitter_registry.size(), 32, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            ParticleEmitter& emitter = emitter_registry.components[i];
+
+            for (Particle& p : emitter.particles) {
+                p.pos.x += p.dir.x * elapsed_ms * (p.lifespan_ms - (p.time_elapsed_ms)) * 0.0009;
+                p.pos.y += p.dir.y * elapsed_ms * (p.lifespan_ms - (p.time_elapsed_ms)) * 0.0009;
+            }
+        }
+    });
+}
+
+void PhysicsSystem::update_dash_movement(Entity entity, float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    Motion& player_motion = registry.motions.get(registry.players.entities[0]);
+    Motion& motion = registry.motions.get(entity);
+    auto& dashing_enemy = registry.enemyDashes.get(entity);
+    if (has_dashing_los(motion.position, player_motion.position) || dashing_enemy.current_charge_timer > dashing_enemy.charge_time) {
+        if (dashing_enemy.current_charge_timer < dashing_enemy.charge_time) {
+            motion.velocity = { 0, 0 };
+            if (registry.lightUps.has(entity)) {
+                registry.lightUps.remove(entity);
+            }
+            dashing_enemy.target_pos = tile_centre(world_to_tile(player_motion.position));
+            dashing_enemy.current_charge_timer += elapsed_ms;
+        }
+        else {
+            motion.velocity = { 500.f, 500.f };
+            // TODO: edit here as well for dash anim
+            if (!registry.lightUps.has(entity)) {
+                auto& lights_up = registry.lightUps.emplace(entity);
+                lights_up.duration_ms = dashing_enemy.charge_time;
+            }
+            vec2 direction = {
+                dashing_enemy.target_pos.x - motion.position.x,
+                dashing_enemy.target_pos.y - motion.position.y
+            };
+
+            float length = sqrt(direction.x * direction.x + direction.y * direction.y);
+
+            if (length > 0) {
+                direction.x /= length;
+                direction.y /= length;
+            }
+            else {
+                dashing_enemy.current_charge_timer = 0;
+                return;
+            }
+
+            float distance_to_target = sqrt(pow(dashing_enemy.target_pos.x - motion.position.x, 2) + pow(dashing_enemy.target_pos.y - motion.position.y, 2));
+
+            float step_x = direction.x * motion.velocity.x * step_seconds;
+            float step_y = direction.y * motion.velocity.y * step_seconds;
+            float step_distance = sqrt(pow(step_x, 2) + pow(step_y, 2));
+
+            // never step past the target
+            vec2 dash_step = {step_x, step_y};
+            if (step_distance >= distance_to_target) {
+                dash_step = dashing_enemy.target_pos - motion.position;
+            }
+
+            // the dash ends early if it runs into a solid object
+            SweepHit hit = sweep_solids(motion, dash_step);
+            motion.position += dash_step * hit.time + hit.normal * SWEEP_SKIN;
+            if (hit.hit || step_distance >= distance_to_target) {
+                dashing_enemy.current_charge_timer = 0;
+            }
+        }
+    }
+    else {
+        dashing_enemy.current_charge_timer = 0.f;
+        motion.velocity = { 100.f, 100.f };
+        if (registry.lightUps.has(entity)) {
+            registry.lightUps.remove(entity);
+        }
+        update_enemy_movement(entity, step_seconds);
+    }
+}
+
+void PhysicsSystem::move_dashers(float elapsed_ms)
+{
+    ComponentContainer<Dasher> &dashers = registry.dashers;
+    for (uint i = 0; i < dashers.size(); i++) {
+        Entity entity = dashers.entities[i];
+        if (registry.deathTimers.has(entity)) {
             continue;
         }
 
-        if (collides(motion_solid, new_motion_y)) {
-            motion.velocity.y = 0;
-            break;
+        Dasher& dasher = dashers.components[i];
+        dasher.pending_seconds += elapsed_ms / 1000.f;
+        if (ai_lod.update_due(entity, registry.motions.get(entity).position)) {
+            update_dash_movement(entity, dasher.pending_seconds * 1000.f);
+            dasher.pending_seconds = 0.f;
         }
     }
+}
 
-    // update y value
-    motion.position[1] += motion.velocity[1] * step_seconds;
+void PhysicsSystem::move_bosses(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    for (Entity entity : registry.bosses.entities) {
+        if (!registry.deathTimers.has(entity)) {
+            update_boss_movement(entity, step_seconds);
+        }
+    }
+}
+
+void PhysicsSystem::aim_homing_projectiles()
+{
+    Motion& player_motion = registry.motions.get(registry.players.entities[0]);
+    for (Entity entity : registry.homings.entities) {
+        Motion& motion = registry.motions.get(entity);
+        motion.angle = atan2(motion.position.y - player_motion.position.y, motion.position.x - player_motion.position.x);
+    }
+}
+
+void PhysicsSystem::move_projectiles(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    for (Entity entity : registry.projectiles.entities) {
+        Motion& motion = registry.motions.get(entity);
+        vec2 projectile_step = {-cos(motion.angle) * motion.velocity.x * step_seconds,
+                                -sin(motion.angle) * motion.velocity.y * step_seconds};
+
+        // fast projectiles are swept so they can't pass through thin walls between frames
+        // on a hit they're left just inside the solid, the collision pass picks that up next step
+        SweepHit hit = sweep_solids(motion, projectile_step);
+        if (hit.hit) {
+            motion.position += projectile_step * hit.time - hit.normal * PROJECTILE_EMBED_DEPTH;
+        } else {
+            motion.position += projectile_step;
+        }
+    }
+}
+
+void PhysicsSystem::move_spikes(float elapsed_ms)
+{
+    float step_seconds = elapsed_ms / 1000.f;
+    Motion& player_motion = registry.motions.get(registry.players.entities[0]);
+    for (Entity entity : registry.spikes.entities) {
+        Motion& spike_motion = registry.motions.get(entity);
+        Spike& spike = registry.spikes.get(entity);
+
+        if (!spike.attack) {
+            vec2 follow_dir = player_motion.position - spike_motion.position;
+
+            follow_dir = distance(vec2(0, 0), follow_dir) == 0 ? follow_dir : normalize(follow_dir);
+            spike_motion.velocity = 200.f * follow_dir;
+
+            spike_motion.position += spike_motion.velocity * step_seconds;
+        } else {
+            // radius-based collision - excluded this from AABB detection, only collision entry should be here
+            // technically would be more ideal to have player BB vs circle ... 
+            if (ellipse_rect_collision(175, 175, spike_motion.position, player_motion.position)) {
+                record_collision(registry.players.entities[0], entity);
+            }
+        }
+    }
+}
+
+void PhysicsSystem::set_layers_interact(COLLISION_LAYER a, COLLISION_LAYER b, bool interact)
+{
+    if (interact) {
+        layer_masks[(int)a] |= (uint8_t)(1 << (int)b);
+        layer_masks[(int)b] |= (uint8_t)(1 << (int)a);
+    } else {
+        layer_masks[(int)a] &= (uint8_t)~(1 << (int)b);
+        layer_masks[(int)b] &= (uint8_t)~(1 << (int)a);
+    }
 }
 
 void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current_map)
 {
     map = current_map;
-    std::vector<Entity> collided_solids;
-	// Check for collisions between all moving entities
-    ComponentContainer<Motion> &motion_container = registry.motions;
-    for (uint i = 0; i < motion_container.components.size(); i++)
+
+	// Check for collisions between entities on a collision layer
+    // only pairs whose layers interact are tested, everything without a layer is skipped entirely
+    // moving colliders are tested pairwise, static ones are only looked up around each moving one
+    // moving colliders that have been still for SLEEP_AFTER_STEPS steps are asleep and skip the tests against each
+    // other: neither moved since the last test found them apart
+    ComponentContainer<COLLISION_LAYER> &collider_container = registry.colliders;
+    for (uint i = 0; i < collider_container.size(); i++)
     {
-        Motion &motion_i = motion_container.components[i];
-        Entity entity_i = motion_container.entities[i];
+        Entity entity = collider_container.entities[i];
+        if (!solid_grid.contains(entity) && registry.motions.has(entity) && !registry.rests.has(entity))
+            registry.rests.emplace(entity);
+    }
 
-        // note starting j at i+1 to compare all (i,j) pairs only once (and to not compare with itself)
-        for (uint j = i + 1; j < motion_container.components.size(); j++)
-        {
-            Motion &motion_j = motion_container.components[j];
-            if (collides(motion_i, motion_j))
-            {
-                Entity entity_j = motion_container.entities[j];
+    frame_vector<DynamicCollider> awake_colliders;
+    frame_vector<DynamicCollider> sleeping_colliders;
+    awake_colliders.reserve(collider_container.size());
+    for (uint i = 0; i < collider_container.size(); i++)
+    {
+        Entity entity = collider_container.entities[i];
+        if (solid_grid.contains(entity) || !registry.motions.has(entity))
+            continue;
 
-                bool is_colliding = true;
+        Motion &motion = registry.motions.get(entity);
+        Rest &rest = registry.rests.get(entity);
+        if (motion.velocity == vec2(0.f) && motion.position == rest.position && motion.scale == rest.scale)
+            rest.steps_at_rest++;
+        else
+            rest = {motion.position, motion.scale, 0};
+
+        DynamicCollider collider = {entity, &motion, collider_container.components[i], &rest};
+        if (rest.steps_at_rest > SLEEP_AFTER_STEPS)
+            sleeping_colliders.push_back(collider);
+        else
+            awake_colliders.push_back(collider);
+    }
 
-                // if player is entity_i do mesh-based collision with entity_i
-                if (registry.stickies.has(entity_i) && registry.players.has(entity_j))
-                {
-                    is_colliding = mesh_collides(entity_i, motion_i, motion_j);
-                }
-                
+    auto test_dynamic_pair = [&](DynamicCollider &collider_i, DynamicCollider &collider_j)
+    {
+        if (layers_interact(collider_i.layer, collider_j.layer) &&
+            test_collider_pair(collider_i.entity, *collider_i.motion, collider_i.layer, collider_j.entity, *collider_j.motion, collider_j.layer))
+        {
+            // touching colliders never fall asleep, a sleeping one woken here is tested again next step
+            collider_i.rest->steps_at_rest = 0;
+            collider_j.rest->steps_at_rest = 0;
+        }
+    };
+    auto test_static_neighbours = [&](DynamicCollider &collider)
+    {
+        vec2 half = abs(collider.motion->scale) / 2.f;
+        solid_grid.for_each_near(collider.motion->position - half, collider.motion->position + half, [&](const SolidGrid::SolidEntry &entry)
+        {
+            if (layers_interact(collider.layer, entry.layer))
+                test_collider_pair(collider.entity, *collider.motion, collider.layer, entry.entity, entry.motion, entry.layer);
+        });
+    };
 
-                if (is_colliding)
-                {
-                    if ((registry.deadlys.has(entity_i) && registry.players.has(entity_j)) || (registry.deadlys.has(entity_j) && registry.players.has(entity_i))) {
-                        if (enemy_player_collides(motion_i, motion_j)) {
-                            registry.collisions.emplace_with_duplicates(entity_i, entity_j);
-                            registry.collisions.emplace_with_duplicates(entity_j, entity_i);
-                        }
-                    } else if ((registry.solidObjs.has(entity_i) && registry.players.has(entity_j)) || (registry.solidObjs.has(entity_j) && registry.players.has(entity_i))) {
-                        if (registry.solidObjs.has(entity_i)) {
-                            collided_solids.push_back(entity_i);
-                        } else {
-                            collided_solids.push_back(entity_j);
-                        }
-                    } else if (!(registry.spikes.has(entity_i) || registry.spikes.has(entity_j))) {
-                        // Create a collisions event
-                    // We are abusing the ECS system a bit in that we potentially insert multiple collisions for the same entity
-                        registry.collisions.emplace_with_duplicates(entity_i, entity_j);
-                        registry.collisions.emplace_with_duplicates(entity_j, entity_i);
-                    }
-                }
-            }
-            else
-            {
-                if (registry.players.has(entity_i))
-                    registry.players.get(entity_i).last_pos = motion_i.position;
-            }
-		}
+    for (uint i = 0; i < awake_colliders.size(); i++)
+    {
+        // note starting j at i+1 to compare all (i,j) pairs only once (and to not compare with itself)
+        for (uint j = i + 1; j < awake_colliders.size(); j++)
+            test_dynamic_pair(awake_colliders[i], awake_colliders[j]);
+        for (DynamicCollider &sleeping : sleeping_colliders)
+            test_dynamic_pair(awake_colliders[i], sleeping);
+        test_static_neighbours(awake_colliders[i]);
 	}
+    // overlaps with statics are still reported every step, a trigger can appear under a sleeping player
+    for (DynamicCollider &sleeping : sleeping_colliders)
+        test_static_neighbours(sleeping);
+    solid_grid.collect();
 
     // Modify health buffs that are not touching player
     
@@ -1071,7 +1209,8 @@ void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current
 
 
         // Player able to interact with tenant? (if so no pathfinding required)
-        if (distance(tenant_pos, player_pos) <= 100 && tenant.path.size() == 0) {
+        size_t path_remaining = path_pool.size(tenant.path) - tenant.path_index;
+        if (distance(tenant_pos, player_pos) <= 100 && path_remaining == 0) {
             tenant.player_in_radius = true;
         } else {
             tenant.player_in_radius = false;
@@ -1079,16 +1218,18 @@ void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current
         
         // Check if tenant has not found path yet
         if (!tenant.on_path) {
-            tenant.path = find_path(tenant_motion, player_motion);
+            frame_vector<vec2> points = find_path(tenant_motion, player_motion);
+            tenant.path = path_pool.write(e, points.data(), points.size());
+            tenant.path_index = 0;
             tenant.on_path = true;
-            if (tenant.path.size() == 0) {
+            if (points.size() == 0) {
                 std::cout << "Error: path not found for tenant" << std::endl;
 				exit(1);
             }
         }
         
 
-        while (tenant.path.size() != 0) {
+        while (tenant.path_index < path_pool.size(tenant.path)) {
 
 
             // Speed up offscreen movement
@@ -1099,11 +1240,11 @@ void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current
                 tenant_motion.speed = 100;
             }
 
-            vec2 target = tenant.path[0];
+            vec2 target = path_pool.at(tenant.path, tenant.path_index);
             vec2 towards_path = normalize(target - tenant_pos);
 
             // Close to player - adjust instead of moving on path
-            if (tenant.path.size() == 1) {
+            if (tenant.path_index == path_pool.size(tenant.path) - 1) {
                 float stand_offset = 75;
 
                 
@@ -1114,12 +1255,11 @@ void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current
                 // Set to exactly where we want it when it's close enough, then empty the path
                 if (distance(tenant_pos, target) <= 5) {
                     tenant_motion.position = target;
-                    tenant.path.clear();
+                    tenant.path_index = path_pool.size(tenant.path);
                     break;
                 }
             } else if (distance(tenant_pos, target) <= 50) { // Path target reached
-                std::vector<vec2>& tpath = tenant.path;
-                tpath.erase(tenant.path.begin());
+                tenant.path_index++;
                 continue;
             }
 
@@ -1148,203 +1288,24 @@ void PhysicsSystem::step(float elapsed_ms, std::vector<std::vector<int>> current
     }
 
 
-    // Smoke particle movement - or maybe all particles ?
-    for (Entity e : registry.emitters.entities) {
-        ParticleEmitter& emitter = registry.emitters.get(e);
-
-        for (Particle& p : emitter.particles) {
-            p.pos.x += p.dir.x * elapsed_ms * (p.lifespan_ms - (p.time_elapsed_ms)) * 0.0009;
-            p.pos.y += p.dir.y * elapsed_ms * (p.lifespan_ms - (p.time_elapsed_ms)) * 0.0009;
-        }
-    }
-    
 	// Move based on how much time has passed, this is to (partially) avoid
 	// having entities move at different speed based on the machine.
-	auto& motion_registry = registry.motions;
-	for(uint i = 0; i< motion_registry.size(); i++)
-	{
-		Motion& motion = motion_registry.components[i];
-		Entity entity = motion_registry.entities[i];
-		float step_seconds = elapsed_ms / 1000.f;
-    if (registry.players.has(entity)) {
-        auto& player = registry.players.get(entity);
-        // Updating speed to make sure most recent value is applied to motion
-        if (distance({0, 0}, motion.velocity) != 0) {
-            motion.velocity = (1 / distance({0, 0}, motion.velocity)) * motion.velocity;
-        }
-
-        float temp_multiplier = 1.f;
-        if (registry.powerups.has(entity)) {
-            Powerup& powerup = registry.powerups.get(entity);
-            if (powerup.type == PowerupType::SPEED_BOOST && (player.is_dash_up || (!player.is_dash_up && (player.curr_dash_cooldown_ms < (player.dash_cooldown_ms - player.dash_time))))) {
-                temp_multiplier *= powerup.multiplier;
-            }
-        }
-        
-        if (player.slowed_duration_ms <= 0.f) {
-            motion.velocity = motion.speed * temp_multiplier * motion.velocity;
-        }
-        else {
-            motion.velocity = motion.speed * motion.velocity * temp_multiplier * player.slowed_amount;
-        }
-
-        // PLAYER x SOLID COLLISION HANDLING
-
-        // check if new x value will collide with any solid objects
-        float new_x = motion.position[0] + (motion.velocity[0] * step_seconds);
-        Motion new_motion_x = {{new_x, motion.position.y}, motion.angle, motion.velocity, motion.scale, motion.speed};
-        for (Entity solid : registry.solidObjs.entities) {
-            Motion& motion_solid = registry.motions.get(solid);
-
-            // trying to make it so we're not checking for collision on every single solid object in the scene
-            if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
-                continue;
-            }
-
-            if (collides(motion_solid, new_motion_x)) {
-                motion.velocity.x = 0;
-                break;
-            }
-        }
-
-        // update x value
-        motion.position[0] += motion.velocity[0] * step_seconds;
-
-        // check if new y value will collide with any solid objects
-        float new_y = motion.position[1] + (motion.velocity[1] * step_seconds);
-        Motion new_motion_y = {{motion.position.x, new_y}, motion.angle, motion.velocity, motion.scale, motion.speed};
-        for (Entity solid : registry.solidObjs.entities) {
-            Motion& motion_solid = registry.motions.get(solid);
-
-            // trying to make it so we're not checking for collision on every single solid object in the scene
-            if (distance(motion_solid.position, motion.position) > 3 * max(abs(motion.scale.x), abs(motion.scale.y))) {
-                continue;
-            }
-
-            if (collides(motion_solid, new_motion_y)) {
-                motion.velocity.y = 0;
-                break;
-            }
-        }
-
-        // update y value
-		motion.position[1] += motion.velocity[1] * step_seconds;
-
-    } else {
-			//Handle contact damage enemies
-			if (registry.deadlys.has(entity)) {
-				if (!registry.projectiles.has(entity)) {
-                    //A* pathfinding
-                    if (!registry.deathTimers.has(entity)) {
-                        if (registry.deadlys.get(entity).enemy_type == ENEMY_TYPES::SWARM) {
-                            update_swarm_movement(entity, step_seconds);
-                            
-                        }
-                        else if (registry.deadlys.get(entity).enemy_type == ENEMY_TYPES::DASHING) {
-                            Motion& player_motion = registry.motions.get(registry.players.entities[0]);
-                            auto& dashing_enemy = registry.enemyDashes.get(entity);
-                            if (has_dashing_los(registry.motions.get(entity).position, player_motion.position) || dashing_enemy.current_charge_timer > dashing_enemy.charge_time) {
-                                if (dashing_enemy.current_charge_timer < dashing_enemy.charge_time) {
-                                    registry.motions.get(entity).velocity = { 0, 0 };
-                                    if (registry.lightUps.has(entity)) {
-                                        registry.lightUps.remove(entity);
-                                    }
-                                    int grid_x = static_cast<int>((player_motion.position.x - GRID_OFFSET_X) / TILE_SIZE);
-                                    int grid_y = static_cast<int>((player_motion.position.y - GRID_OFFSET_Y) / TILE_SIZE);
-                                    dashing_enemy.target_pos = { (640 - (25 * 100)) + (grid_x * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (grid_y * TILE_SIZE) + (TILE_SIZE / 2) };
-                                    dashing_enemy.current_charge_timer += elapsed_ms;
-                                }
-                                else {
-                                    registry.motions.get(entity).velocity = { 500.f, 500.f };
-                                    // TODO: edit here as well for dash anim
-                                    if (!registry.lightUps.has(entity) && registry.deadlys.get(entity).enemy_type != ENEMY_TYPES::FINAL_BOSS) {
-                                        auto& lights_up = registry.lightUps.emplace(entity);
-                                        lights_up.duration_ms = dashing_enemy.charge_time;
-                                    }
-                                    vec2 direction = {
-                                        dashing_enemy.target_pos.x - motion.position.x,
-                                        dashing_enemy.target_pos.y - motion.position.y
-                                    };
-
-                                    float length = sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                                    if (length > 0) {
-                                        direction.x /= length;
-                                        direction.y /= length;
-                                    }
-                                    else {
-                                        dashing_enemy.current_charge_timer = 0;
-                                        continue;
-                                    }
-
-                                    float distance_to_target = sqrt(pow(dashing_enemy.target_pos.x - motion.position.x, 2) + pow(dashing_enemy.target_pos.y - motion.position.y, 2));
-
-                                    float step_x = direction.x * motion.velocity.x * step_seconds;
-                                    float step_y = direction.y * motion.velocity.y * step_seconds;
-                                    float step_distance = sqrt(pow(step_x, 2) + pow(step_y, 2));
-
-                                    if (step_distance >= distance_to_target) {
-                                        motion.position = dashing_enemy.target_pos;
-                                        dashing_enemy.current_charge_timer = 0;
-                                    }
-                                    else {
-                                        motion.position.x += step_x;
-                                        motion.position.y += step_y;
-                                    }
-                                }
-                            }
-                            else {
-                                dashing_enemy.current_charge_timer = 0.f;
-                                registry.motions.get(entity).velocity = { 100.f, 100.f };
-                                if (registry.lightUps.has(entity)) {
-                                    registry.lightUps.remove(entity);
-                                }
-                                update_enemy_movement(entity, step_seconds);
-                            }
-                        } else if (registry.deadlys.get(entity).enemy_type == ENEMY_TYPES::FINAL_BOSS) {
-                            update_boss_movement(entity, step_seconds);
-                        }
-                        else{
-                            update_enemy_movement(entity, step_seconds);
-                        }
-                        
-                    }
-                    
-                }
-                else
-                    {
-                        if (registry.deadlys.get(entity).enemy_type == ENEMY_TYPES::HOMING_PROJECTILE) {
-                            Motion& player_motion = registry.motions.get(registry.players.entities[0]);
-                            motion.angle = atan2(motion.position.y - player_motion.position.y, motion.position.x - player_motion.position.x);
-                        }
-                        motion.position.x -= cos(motion.angle) * motion.velocity.x * step_seconds;
-                        motion.position.y -= sin(motion.angle) * motion.velocity.y * step_seconds;
-                    }
-            }
-
-            if (registry.spikes.has(entity)) {
-                Motion& spike_motion = registry.motions.get(entity);
-                Motion& player_motion = registry.motions.get(registry.players.entities[0]);
-                Spike& spike = registry.spikes.get(entity);
-
-                if (!spike.attack) {
-                    vec2 follow_dir = player_motion.position - spike_motion.position;
-
-                    follow_dir = distance(vec2(0, 0), follow_dir) == 0 ? follow_dir : normalize(follow_dir);
-                    spike_motion.velocity = 200.f * follow_dir;
-
-                    spike_motion.position += spike_motion.velocity * step_seconds;
-                } else {
-                    // radius-based collision - excluded this from AABB detection, only collision entry should be here
-                    // technically would be more ideal to have player BB vs circle ... 
-                    if (ellipse_rect_collision(175, 175, spike_motion.position, player_motion.position)) {
-                        registry.collisions.emplace_with_duplicates(registry.players.entities[0], entity);
-                        registry.collisions.emplace_with_duplicates(entity, registry.players.entities[0]);
-                    }
-                }
-            }
-        }
-    }
+	// Each kind of mover has its own container filled in at spawn, so every kernel runs over its own batch
+	// homing projectiles are aimed before projectiles move, everything else is independent of order
+	// chasers and dashers away from the camera only run their AI every few steps
+	// swarms, particles and path searches are scheduled as their own systems after the step
+	vec2 camera_position = registry.cameras.size() > 0 ? registry.motions.get(registry.cameras.entities.front()).position : player_motion.position;
+	ai_lod.begin_frame(camera_position);
+	move_players(elapsed_ms);
+	move_chasers(elapsed_ms);
+	move_dashers(elapsed_ms);
+	move_bosses(elapsed_ms);
+	aim_homing_projectiles();
+	move_projectiles(elapsed_ms);
+	move_spikes(elapsed_ms);
+
+    // hand back the path storage of enemies that died since the last step
+    path_pool.collect();
 
     for (Entity entity : registry.blockedTimers.entities)
     {
@@ -4,6 +4,11 @@
 #include "tiny_ecs.hpp"
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
+#include "path_request_queue.hpp"
+#include "frame_arena.hpp"
+
+// A* path from the enemy position towards the tile the player is on
+frame_vector<vec2> find_path(const Motion &enemy, const Motion &player);
 
 // A simple physics system that moves rigid bodies and checks for collision
 class PhysicsSystem
@@ -11,15 +16,56 @@ class PhysicsSystem
 public:
 	void step(float elapsed_ms, std::vector<std::vector<int>> current_map);
 	bool has_los(const vec2& start, const vec2& end);
+	bool has_dashing_los(const vec2& start, const vec2& end);
 	void update_enemy_movement(Entity enemy, float step_seconds);
 	void update_swarm_movement(Entity leader, float step_seconds);
 	void update_boss_movement(Entity enemy, float step_seconds);
+	void update_dash_movement(Entity enemy, float elapsed_ms);
+
+	// Movement kernels step() runs, each over its own container with no per-entity type tests
+	// public so any one of them can be timed on its own
+	void move_players(float elapsed_ms);
+	void move_chasers(float elapsed_ms);
+	// swarm members that leave the map are only removed by remove_swarm_leavers, so these two can run on a worker
+	void move_swarms(float elapsed_ms);
+	void move_particles(float elapsed_ms);
+	void remove_swarm_leavers();
+	void move_dashers(float elapsed_ms);
+	void move_bosses(float elapsed_ms);
+	void aim_homing_projectiles();
+	void move_projectiles(float elapsed_ms);
+	void move_spikes(float elapsed_ms);
+
+	// enemy re-paths are queued here and worked through a few at a time each frame by process_path_requests
+	PathRequestQueue path_requests;
+	// searches allocate from the frame arena, schedule it on the main thread
+	void process_path_requests();
+
+	// Configures whether entities on these two layers are tested against each other
+	void set_layers_interact(COLLISION_LAYER a, COLLISION_LAYER b, bool interact);
+	bool layers_interact(COLLISION_LAYER a, COLLISION_LAYER b) const
+	{
+		return (layer_masks[(int)a] >> (int)b) & 1;
+	}
 
 	PhysicsSystem()
 	{
+		// only pairs the world reacts to
+		set_layers_interact(COLLISION_LAYER::PLAYER, COLLISION_LAYER::ENEMY, true);
+		set_layers_interact(COLLISION_LAYER::PLAYER, COLLISION_LAYER::PROJECTILE, true);
+		set_layers_interact(COLLISION_LAYER::PLAYER, COLLISION_LAYER::TRIGGER, true);
+		set_layers_interact(COLLISION_LAYER::PROJECTILE, COLLISION_LAYER::SOLID, true);
+		set_layers_interact(COLLISION_LAYER::ATTACK, COLLISION_LAYER::ENEMY, true);
+		set_layers_interact(COLLISION_LAYER::ATTACK, COLLISION_LAYER::PROJECTILE, true);
 	}
 
 private:
+	// bit j of layer_masks[i] is set if layer i interacts with layer j
+	uint8_t layer_masks[collision_layer_count] = {};
+
+	// swarm members that left the map during move_swarms
+	std::vector<Entity> swarm_leavers;
+
 	
 	// compares elliptical bounding box to rectangular bounding box
 	bool static ellipse_rect_collision(float x_rad, float y_rad, vec2 circle_pos, vec2 rect_pos) {
@@ -34,4 +80,7 @@ private:
 		}
 		return false;
 	}
-};
\ No newline at end of file
+};
+
+// the one physics system, the world clears its queued path requests when a level is loaded
+extern PhysicsSystem phsyics;
@@ -3,6 +3,7 @@
 #include "player_controller.hpp"
 #include "animation_system.hpp"
 #include "world_system.hpp"
+#include "audio_system.hpp"
 
 #include <iostream>
 #include <random>
@@ -74,7 +75,7 @@ void PlayerController::step(float elapsed_ms_since_last_update)
 
         attack.duration_ms -= elapsed_ms_since_last_update;
 
-        if (animSet.current_frame == animSet.animations[animSet.current_animation].sprite_indices.size() - 1)
+        if (animSet.current_frame == animation_library.current(animSet).sprite_indices.size() - 1)
         {
             registry.remove_all_components_of(entity);
         }
@@ -176,7 +177,7 @@ void PlayerController::step(float elapsed_ms_since_last_update)
     switch (player.state)
     {
     case PLAYER_STATE::DEAD:
-        animSet.current_animation = "player_die";
+        animation_library.play(animSet, PLAYER_CLIP::DIE);
         animSet.current_frame = 0;
         break;
     case PLAYER_STATE::DASH:
@@ -184,75 +185,75 @@ void PlayerController::step(float elapsed_ms_since_last_update)
     case PLAYER_STATE::ATTACK:
         if (player.last_direction == vec2(0, 1))
         {
-            if (animSet.current_animation != "player_attack_f")
+            if (!animation_library.is_playing(animSet, PLAYER_CLIP::ATTACK_F))
             {
                 animSet.current_frame = 0;
             }
 
-            animSet.current_animation = "player_attack_f";
+            animation_library.play(animSet, PLAYER_CLIP::ATTACK_F);
         }
         else if (player.last_direction == vec2(1, 0))
         {
-            if (animSet.current_animation != "player_attack_s")
+            if (!animation_library.is_playing(animSet, PLAYER_CLIP::ATTACK_S))
             {
                 animSet.current_frame = 0;
             }
 
-            animSet.current_animation = "player_attack_s";
+            animation_library.play(animSet, PLAYER_CLIP::ATTACK_S);
         }
         else if (player.last_direction == vec2(-1, 0))
         {
-            if (animSet.current_animation != "player_attack_s")
+            if (!animation_library.is_playing(animSet, PLAYER_CLIP::ATTACK_S))
             {
                 animSet.current_frame = 0;
             }
 
-            animSet.current_animation = "player_attack_s";
+            animation_library.play(animSet, PLAYER_CLIP::ATTACK_S);
         }
         else
         {
-            if (animSet.current_animation != "player_attack_b")
+            if (!animation_library.is_playing(animSet, PLAYER_CLIP::ATTACK_B))
             {
                 animSet.current_frame = 0;
             }
 
-            animSet.current_animation = "player_attack_b";
+            animation_library.play(animSet, PLAYER_CLIP::ATTACK_B);
         }
         break;
     case PLAYER_STATE::RUN:
         if (player.last_direction == vec2(1, 0))
         {
-            animSet.current_animation = "player_run_s";
+            animation_library.play(animSet, PLAYER_CLIP::RUN_S);
         }
         else if (player.last_direction == vec2(-1, 0))
         {
-            animSet.current_animation = "player_run_s";
+            animation_library.play(animSet, PLAYER_CLIP::RUN_S);
         }
         else if (player.last_direction == vec2(0, -1))
         {
-            animSet.current_animation = "player_run_b";
+            animation_library.play(animSet, PLAYER_CLIP::RUN_B);
         }
         else
         {
-            animSet.current_animation = "player_run_f";
+            animation_library.play(animSet, PLAYER_CLIP::RUN_F);
         }
         break;
     case PLAYER_STATE::IDLE:
         if (player.last_direction == vec2(1, 0))
         {
-            animSet.current_animation = "player_idle_s";
+            animation_library.play(animSet, PLAYER_CLIP::IDLE_S);
         }
         else if (player.last_direction == vec2(-1, 0))
         {
-            animSet.current_animation = "player_idle_s";
+            animation_library.play(animSet, PLAYER_CLIP::IDLE_S);
         }
         else if (player.last_direction == vec2(0, -1))
         {
-            animSet.current_animation = "player_idle_b";
+            animation_library.play(animSet, PLAYER_CLIP::IDLE_B);
         }
         else
         {
-            animSet.current_animation = "player_idle_f";
+            animation_library.play(animSet, PLAYER_CLIP::IDLE_F);
         }
         break;
     default:
@@ -321,15 +322,15 @@ void PlayerController::step(float elapsed_ms_since_last_update)
 
                 if (registry.experiences.has(entity))
                 {
-                    animation.current_animation = "experience_collect";
-                    Mix_PlayChannel(-1, world->exp_sound, 0);
+                    animation_library.play(animation, "experience_collect");
+                    audio.play(SOUND_ASSET_ID::EXP);
                     animation.current_frame = 0;
                 }
             }
         }
 
         // Remove entity when animation is finished playing
-        // if (collectible.is_collected && animation.current_frame == animation.animations[animation.current_animation].sprite_indices.size() - 1)
+        // if (collectible.is_collected && animation.current_frame == animation_library.current(animation).sprite_indices.size() - 1)
         // {
         //     auto &collectible_experience = registry.experiences.get(entity);
 
@@ -650,7 +651,7 @@ void PlayerController::on_mouse_button(int button, int action, int mods)
                 upgradeCardComponent.onClick();
 
                 // Play upgrade sound
-                Mix_PlayChannel(-1, world->level_up_sound, 0);
+                audio.play(SOUND_ASSET_ID::LEVEL_UP);
 
                 for (Entity entity : registry.upgradeCards.entities)
                 {
@@ -682,7 +683,7 @@ void PlayerController::on_mouse_button(int button, int action, int mods)
             if (upgradeCardComponent.hovering && !registry.selectedCards.has(entity))
             {
                 // Play click button sound
-                Mix_PlayChannel(-1, world->button_click_sound, 0);
+                audio.play(SOUND_ASSET_ID::BUTTON_CLICK);
 
                 registry.selectedCards.emplace(entity);
                 uiComponent.scale = upgradeCardComponent.original_scale * vec2(1.03f, 1.03f);
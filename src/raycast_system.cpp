@@ -0,0 +1,167 @@
+// internal
+#include "raycast_system.hpp"
+
+RaycastSystem raycaster;
+
+void RaycastSystem::load_map(const std::vector<std::vector<int>> &map)
+{
+	memo.clear();
+
+	height = (int)map.size();
+	width = (height > 0) ? (int)map[0].size() : 0;
+	words_per_row = (width + 63) / 64;
+
+	blocked.assign(words_per_row * height, 0);
+	blocked_x_dash.assign(words_per_row * height, 0);
+	blocked_y_dash.assign(words_per_row * height, 0);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			if (!tile_walkable(map[y][x]))
+			{
+				set_bit(blocked, x, y);
+			}
+		}
+	}
+
+	// a dash is blocked on a tile if it or either tile beside the direction of travel is blocked
+	// tiles outside the map count as blocked, so the map edge also blocks the tiles next to it
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			if (is_blocked(x, y) || is_blocked(x, y - 1) || is_blocked(x, y + 1))
+			{
+				set_bit(blocked_x_dash, x, y);
+			}
+			if (is_blocked(x, y) || is_blocked(x - 1, y) || is_blocked(x + 1, y))
+			{
+				set_bit(blocked_y_dash, x, y);
+			}
+		}
+	}
+}
+
+bool RaycastSystem::is_blocked(int x, int y) const
+{
+	return test_bit(blocked, x, y);
+}
+
+bool RaycastSystem::has_los(const vec2 &start, const vec2 &end)
+{
+	return query(world_to_tile(start), world_to_tile(end), LOS_TYPE::STANDARD);
+}
+
+bool RaycastSystem::has_dashing_los(const vec2 &start, const vec2 &end)
+{
+	return query(world_to_tile(start), world_to_tile(end), LOS_TYPE::DASHING);
+}
+
+void RaycastSystem::has_los_batch(const std::vector<vec2> &starts, const vec2 &end, std::vector<bool> &visible, LOS_TYPE type)
+{
+	ivec2 end_tile = world_to_tile(end);
+
+	visible.resize(starts.size());
+	for (size_t i = 0; i < starts.size(); i++)
+	{
+		visible[i] = query(world_to_tile(starts[i]), end_tile, type);
+	}
+}
+
+bool RaycastSystem::query(ivec2 start_tile, ivec2 end_tile, LOS_TYPE type)
+{
+	// a ray starting or ending off the map always ends on a blocked tile, so only rays inside the map are cached
+	// and their coordinates always fit the key
+	if (test_bit(blocked, start_tile.x, start_tile.y) || test_bit(blocked, end_tile.x, end_tile.y))
+	{
+		return false;
+	}
+
+	// 15 bits per coordinate is plenty for any of our maps, the top bits hold the query type
+	uint64_t key = ((uint64_t)(start_tile.x & 0x7FFF)) |
+				   ((uint64_t)(start_tile.y & 0x7FFF) << 15) |
+				   ((uint64_t)(end_tile.x & 0x7FFF) << 30) |
+				   ((uint64_t)(end_tile.y & 0x7FFF) << 45) |
+				   ((uint64_t)type << 60);
+
+	auto it = memo.find(key);
+	if (it != memo.end())
+	{
+		return it->second;
+	}
+
+	bool result = traverse(start_tile, end_tile, type);
+	if (memo.size() >= MEMO_LIMIT)
+	{
+		memo.clear();
+	}
+	memo[key] = result;
+	return result;
+}
+
+// Walks every tile the segment between the two tile centres passes through
+// Ties (passing exactly through a corner) step diagonally, same as the old Bresenham check
+bool RaycastSystem::traverse(ivec2 start_tile, ivec2 end_tile, LOS_TYPE type) const
+{
+	int dx = end_tile.x - start_tile.x;
+	int dy = end_tile.y - start_tile.y;
+	int nx = abs(dx);
+	int ny = abs(dy);
+	int x_step = (dx > 0) ? 1 : -1;
+	int y_step = (dy > 0) ? 1 : -1;
+
+	// every tile but the last also needs the tiles beside it clear when dashing
+	const std::vector<uint64_t> &path_bits = (type == LOS_TYPE::DASHING) ? ((nx > ny) ? blocked_x_dash : blocked_y_dash) : blocked;
+
+	int x = start_tile.x;
+	int y = start_tile.y;
+	int ix = 0;
+	int iy = 0;
+
+	while (ix < nx || iy < ny)
+	{
+		if (test_bit(path_bits, x, y))
+		{
+			return false;
+		}
+
+		// compare the distance along the ray to the next vertical and horizontal tile edges
+		long long decision = (long long)(1 + 2 * ix) * ny - (long long)(1 + 2 * iy) * nx;
+		if (decision == 0)
+		{
+			x += x_step;
+			y += y_step;
+			ix++;
+			iy++;
+		}
+		else if (decision < 0)
+		{
+			x += x_step;
+			ix++;
+		}
+		else
+		{
+			y += y_step;
+			iy++;
+		}
+	}
+
+	return !is_blocked(x, y);
+}
+
+bool RaycastSystem::test_bit(const std::vector<uint64_t> &bits, int x, int y) const
+{
+	// anything outside the map is blocked
+	if (x < 0 || y < 0 || x >= width || y >= height)
+	{
+		return true;
+	}
+	return (bits[y * words_per_row + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void RaycastSystem::set_bit(std::vector<uint64_t> &bits, int x, int y)
+{
+	bits[y * words_per_row + (x >> 6)] |= (uint64_t)1 << (x & 63);
+}
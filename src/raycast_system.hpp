@@ -0,0 +1,55 @@
+#pragma once
+
+// stlib
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "common.hpp"
+
+// Line of sight queries against the tile map
+// The map is packed into one bit per tile (1 = blocked) and rays are traversed tile by tile (DDA)
+// Results only depend on the map, so they are memoized on (start tile, end tile, type) across frames
+// since most enemies don't change tile between frames; the memo is dropped when a new map is loaded
+class RaycastSystem
+{
+public:
+	enum class LOS_TYPE
+	{
+		STANDARD = 0,
+		DASHING = STANDARD + 1, // also requires the tiles beside the ray to be clear
+	};
+
+	// Builds the occupancy grids from the tile map and clears the memo, call whenever a level is loaded
+	void load_map(const std::vector<std::vector<int>> &map);
+
+	bool has_los(const vec2 &start, const vec2 &end);
+	bool has_dashing_los(const vec2 &start, const vec2 &end);
+
+	// Tests every start position against the same end position, results are written to visible (same order as starts)
+	void has_los_batch(const std::vector<vec2> &starts, const vec2 &end, std::vector<bool> &visible, LOS_TYPE type = LOS_TYPE::STANDARD);
+
+	bool is_blocked(int x, int y) const;
+
+private:
+	bool query(ivec2 start_tile, ivec2 end_tile, LOS_TYPE type);
+	bool traverse(ivec2 start_tile, ivec2 end_tile, LOS_TYPE type) const;
+	bool test_bit(const std::vector<uint64_t> &bits, int x, int y) const;
+	void set_bit(std::vector<uint64_t> &bits, int x, int y);
+
+	int width = 0;
+	int height = 0;
+	int words_per_row = 0;
+
+	// blocked tiles
+	std::vector<uint64_t> blocked;
+	// blocked tiles dilated by one along y (for dashes that mostly travel along x) and along x (mostly along y)
+	std::vector<uint64_t> blocked_x_dash;
+	std::vector<uint64_t> blocked_y_dash;
+
+	// cleared when it reaches MEMO_LIMIT so a long level can't grow it without bound
+	static const size_t MEMO_LIMIT = 1 << 16;
+	std::unordered_map<uint64_t, bool> memo;
+};
+
+extern RaycastSystem raycaster;
@@ -0,0 +1,93 @@
+// internal
+#include "render_sort.hpp"
+
+#include <cassert>
+
+static_assert(draw_key::STAGE_SHIFT + draw_key::STAGE_BITS <= 64, "draw key fields don't fit in 64 bits");
+static_assert(effect_count <= (1 << draw_key::EFFECT_BITS), "too many effects for the draw key");
+static_assert(texture_count + sprite_count + 1 <= (1 << draw_key::TEXTURE_BITS), "too many textures for the draw key");
+static_assert(geometry_count <= (1 << draw_key::GEOMETRY_BITS), "too many geometries for the draw key");
+
+int world_stage(RENDER_LAYER layer)
+{
+	switch (layer)
+	{
+	case RENDER_LAYER::FLOOR:
+		return 0;
+	case RENDER_LAYER::FLOOR_DECOR:
+		return 1;
+	case RENDER_LAYER::CREATURES:
+		return 2;
+	case RENDER_LAYER::OBSTACLES:
+		return 3;
+	case RENDER_LAYER::EFFECTS:
+		return 4;
+	case RENDER_LAYER::DEFAULT_LAYER:
+		return 5;
+	case RENDER_LAYER::UI_LAYER_1:
+		return 6;
+	case RENDER_LAYER::UI_LAYER_2:
+		return 7;
+	}
+	return 5;
+}
+
+int texture_slot(const RenderRequest &request)
+{
+	if (request.used_sprite == SPRITE_ASSET_ID::SPRITE_COUNT || request.sprite_index == -1)
+	{
+		return (int)request.used_texture;
+	}
+	return texture_count + 1 + (int)request.used_sprite;
+}
+
+uint64_t make_draw_key(int stage, const RenderRequest &request, uint32_t sequence)
+{
+	assert(stage >= 0 && stage < (1 << draw_key::STAGE_BITS));
+	return ((uint64_t)stage << draw_key::STAGE_SHIFT) |
+		   ((uint64_t)sequence << draw_key::SEQUENCE_SHIFT) |
+		   ((uint64_t)request.used_effect << draw_key::EFFECT_SHIFT) |
+		   ((uint64_t)texture_slot(request) << draw_key::TEXTURE_SHIFT) |
+		   ((uint64_t)request.used_geometry << draw_key::GEOMETRY_SHIFT);
+}
+
+int radix_sort_keys(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch)
+{
+	size_t n = keys.size();
+	if (n < 2)
+	{
+		return 0;
+	}
+	scratch.resize(n);
+
+	int passes = 0;
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = {};
+		for (uint64_t key : keys)
+		{
+			counts[(key >> shift) & 0xFF]++;
+		}
+
+		// every key has the same byte here, this pass wouldn't move anything
+		if (counts[(keys[0] >> shift) & 0xFF] == n)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t &count : counts)
+		{
+			size_t c = count;
+			count = offset;
+			offset += c;
+		}
+		for (uint64_t key : keys)
+		{
+			scratch[counts[(key >> shift) & 0xFF]++] = key;
+		}
+		keys.swap(scratch);
+		passes++;
+	}
+	return passes;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+#include "components.hpp"
+
+// Draw keys put every draw in the frame in one list that sorts into render order
+// From the most significant bits down:
+//   stage    (4)  - world layers in the order they're drawn, then the two screen space UI layers
+//   sequence (32) - depth inside the stage: index in the render request container, the order sprites on the same
+//                   layer have always stacked in
+//   effect   (5)  - shader program
+//   texture  (8)  - texture, or sprite sheet when the request uses one
+//   geometry (5)  - vertex / index buffers
+// The sequence is unique inside a stage, so the state bits below it never change the order: draws are in request
+// order within their stage, and the renderer's bind cache is what skips state a draw shares with the one before it
+namespace draw_key
+{
+	const int GEOMETRY_BITS = 5;
+	const int TEXTURE_BITS = 8;
+	const int EFFECT_BITS = 5;
+	const int SEQUENCE_BITS = 32;
+	const int STAGE_BITS = 4;
+
+	const int GEOMETRY_SHIFT = 0;
+	const int TEXTURE_SHIFT = GEOMETRY_SHIFT + GEOMETRY_BITS;
+	const int EFFECT_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+	const int SEQUENCE_SHIFT = EFFECT_SHIFT + EFFECT_BITS;
+	const int STAGE_SHIFT = SEQUENCE_SHIFT + SEQUENCE_BITS;
+
+	// world stages first (FLOOR ... UI_LAYER_2 drawn as world objects), then UI_LAYER_1 and UI_LAYER_2 in screen space
+	const int SCREEN_SPACE_UI_1 = 8;
+	const int SCREEN_SPACE_UI_2 = 9;
+}
+
+// Stage a world space request on this layer is drawn in, in the order the layers are drawn
+int world_stage(RENDER_LAYER layer);
+
+// Texture slot of a request, sprite sheets come after the plain textures
+int texture_slot(const RenderRequest &request);
+
+uint64_t make_draw_key(int stage, const RenderRequest &request, uint32_t sequence);
+
+inline uint32_t draw_key_sequence(uint64_t key) { return (uint32_t)(key >> draw_key::SEQUENCE_SHIFT); }
+inline int draw_key_stage(uint64_t key) { return (int)(key >> draw_key::STAGE_SHIFT); }
+
+// LSD radix sort on bytes, bytes every key has in common are skipped
+// scratch is reused between frames to avoid allocating
+// Returns the number of passes run, the skipped bytes not counted
+int radix_sort_keys(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch);
@@ -1,28 +1,25 @@
 // internal
 #include "render_system.hpp"
+#include "render_sort.hpp"
+#include "frame_arena.hpp"
+#include "debug_draw.hpp"
+#include "damage_indicator_system.hpp"
 #include <SDL.h>
 
+#include <cstddef>
 #include <iostream>
 
 #include "tiny_ecs_registry.hpp"
 #include <glm/gtc/type_ptr.hpp>
 
-void RenderSystem::drawTexturedMesh(Entity entity,
-									const mat3 &projection)
+// Extra scale some sprites are drawn with to make up for the texture not matching the bounding box
+vec2 RenderSystem::spriteScale(Entity entity)
 {
-	Motion &motion = registry.motions.get(entity);
-	// Transformation code, see Rendering and Transformation in the template
-	// specification for more info Incrementally updates transformation matrix,
-	// thus ORDER IS IMPORTANT
-	Transform transform;
-	transform.translate(motion.position + motion.renderPositionOffset);
-	transform.scale(motion.scale * motion.renderScale);
-	transform.rotate(motion.angle);
+	vec2 scale = {1.f, 1.f};
 
-	// adjusting for discrepancies in texture vs. bb size
 	if (registry.players.has(entity) || registry.tenants.has(entity))
 	{
-		transform.scale(vec2(2.6f, 2.f));
+		scale *= vec2(2.6f, 2.f);
 	}
 
 	if (registry.deadlys.has(entity))
@@ -30,36 +27,70 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 		Deadly &enemy = registry.deadlys.get(entity);
 		if (enemy.enemy_type == ENEMY_TYPES::CONTACT_DMG)
 		{
-			transform.scale(vec2(2.5f, 1.6f));
+			scale *= vec2(2.5f, 1.6f);
 		}
 		else if (enemy.enemy_type == ENEMY_TYPES::CONTACT_DMG_2 || enemy.enemy_type == ENEMY_TYPES::SLOWING_CONTACT || enemy.enemy_type == ENEMY_TYPES::DASHING)
 		{
-			transform.scale(vec2(2.4f, 2.2f));
+			scale *= vec2(2.4f, 2.2f);
 		}
 		else if (enemy.enemy_type == ENEMY_TYPES::RANGED || enemy.enemy_type == ENEMY_TYPES::RANGED_HOMING)
 		{
-			transform.scale(vec2(1.5, 2.7));
+			scale *= vec2(1.5, 2.7);
 		}
 		else if (registry.projectiles.has(entity))
 		{
-			transform.scale(vec2(5, 5));
+			scale *= vec2(5, 5);
 		}
 		else if (enemy.enemy_type == ENEMY_TYPES::FINAL_BOSS)
 		{
-			transform.scale(vec2(2, 1.775));
+			scale *= vec2(2, 1.775);
 		}
 	}
 
 	if (registry.walls.has(entity))
 	{
-		transform.scale(vec2(1.125, 1.125));
+		scale *= vec2(1.125, 1.125);
 	}
 
 	if (registry.healthBuffs.has(entity))
 	{
-		transform.scale(vec2(2, 2));
+		scale *= vec2(2, 2);
 	}
 
+	return scale;
+}
+
+// True if the sprite as drawn overlaps the camera view
+// The sprite scale is rotated before the base scale is applied, so a rotated sprite reaches at most
+// base * length(extra) / 2 from its centre along each axis
+bool RenderSystem::isOnScreen(Entity entity, const vec2 &camera_position)
+{
+	const Motion &motion = registry.motions.get(entity);
+	vec2 base = abs(motion.scale * motion.renderScale);
+	vec2 extra = abs(spriteScale(entity));
+	vec2 half = (motion.angle == 0.f) ? base * extra / 2.f : base * (length(extra) / 2.f);
+	vec2 center = motion.position + motion.renderPositionOffset;
+
+	vec2 screen_half = {window_width_px / 2.f, window_height_px / 2.f};
+	return abs(center.x - camera_position.x) <= half.x + screen_half.x &&
+		   abs(center.y - camera_position.y) <= half.y + screen_half.y;
+}
+
+void RenderSystem::drawTexturedMesh(Entity entity,
+									const mat3 &projection)
+{
+	Motion &motion = registry.motions.get(entity);
+	// Transformation code, see Rendering and Transformation in the template
+	// specification for more info Incrementally updates transformation matrix,
+	// thus ORDER IS IMPORTANT
+	Transform transform;
+	transform.translate(motion.position + motion.renderPositionOffset);
+	transform.scale(motion.scale * motion.renderScale);
+	transform.rotate(motion.angle);
+
+	// adjusting for discrepancies in texture vs. bb size
+	transform.scale(spriteScale(entity));
+
 	assert(registry.renderRequests.has(entity));
 	const RenderRequest &render_request = registry.renderRequests.get(entity);
 
@@ -68,7 +99,7 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 	const GLuint program = (GLuint)effects[used_effect_enum];
 
 	// Setting shaders
-	glUseProgram(program);
+	useProgram(program);
 	gl_has_errors();
 
 	assert(render_request.used_geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
@@ -76,8 +107,7 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 	const GLuint ibo = index_buffers[(GLuint)render_request.used_geometry];
 
 	// Setting vertex and index buffers
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	bindGeometry(vbo, ibo);
 	gl_has_errors();
 
 	// Input data location as in the vertex buffer
@@ -146,9 +176,9 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 		if (render_request.used_sprite == SPRITE_ASSET_ID::SPRITE_COUNT || render_request.sprite_index == -1)
 		{
 			texture_id =
-				texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
+				textures.use(registry.renderRequests.get(entity).used_texture);
 
-			glBindTexture(GL_TEXTURE_2D, texture_id);
+			bindTexture(texture_id);
 			gl_has_errors();
 
 			GLuint uv_offset_loc = glGetUniformLocation(program, "uv_offset");
@@ -159,19 +189,18 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 		}
 		else
 		{
-			texture_id = texture_gl_handles[(GLuint)sprite_sheets[registry.renderRequests.get(entity).used_sprite].texture_id];
+			texture_id = textures.use(sprite_table[(int)render_request.used_sprite].texture);
 
-			glBindTexture(GL_TEXTURE_2D, texture_id);
+			bindTexture(texture_id);
 			gl_has_errors();
 
-			float u0, v0, u1, v1;
-			getUVCoordinates(registry.renderRequests.get(entity).used_sprite, registry.renderRequests.get(entity).sprite_index, u0, v0, u1, v1);
+			const SpriteUV &uv = getSpriteUV(render_request.used_sprite, render_request.sprite_index);
 
 			GLuint uv_offset_loc = glGetUniformLocation(program, "uv_offset");
-			glUniform2f(uv_offset_loc, u0, v0);
+			glUniform2f(uv_offset_loc, uv.offset.x, uv.offset.y);
 
 			GLuint uv_scale_loc = glGetUniformLocation(program, "uv_scale");
-			glUniform2f(uv_scale_loc, (u1 - u0), (v1 - v0));
+			glUniform2f(uv_scale_loc, uv.scale.x, uv.scale.y);
 		}
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::SALMON || render_request.used_effect == EFFECT_ASSET_ID::EGG || render_request.used_effect == EFFECT_ASSET_ID::EGG)
@@ -229,9 +258,9 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 		;
 
 		texture_id =
-			texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
+			textures.use(registry.renderRequests.get(entity).used_texture);
 
-		glBindTexture(GL_TEXTURE_2D, texture_id);
+		bindTexture(texture_id);
 		gl_has_errors();
 
 		GLuint uv_offset_loc = glGetUniformLocation(program, "uv_offset");
@@ -293,26 +322,34 @@ void RenderSystem::drawTexturedMesh(Entity entity,
 	if (render_request.used_effect == EFFECT_ASSET_ID::SMOKE)
 	{
 		assert(registry.emitters.has(entity));
+		const ParticleEmitter &emitter = registry.emitters.get(entity);
+		const Motion &emitter_motion = registry.motions.get(entity);
 
-		for (unsigned int i = 0; i < registry.emitters.get(entity).particles.size(); i++) {
-
-			Particle& p = registry.emitters.get(entity).particles[i];
-			const std::string &name = "offsets[" + std::to_string(i) + "]";
-
-			GLint offset_loc = glGetUniformLocation(currProgram, name.c_str());
+		// particle offsets and ages go up as one block of instance data instead of a pair of uniforms each
+		particle_instances.clear();
+		for (const Particle &p : emitter.particles)
+		{
+			particle_instances.push_back({p.pos.x - emitter_motion.position.x, emitter_motion.position.y - p.pos.y, p.time_elapsed_ms / p.lifespan_ms});
+		}
 
-			glUniform2f(offset_loc, p.pos.x - registry.motions.get(entity).position.x, registry.motions.get(entity).position.y - p.pos.y);
+		if (!particle_instances.empty())
+		{
+			size_t offset = stream_buffer.write(particle_instances.data(), particle_instances.size() * sizeof(vec3), 4 * sizeof(float));
+
+			GLint instance_loc = glGetAttribLocation(currProgram, "in_instance");
+			glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.handle());
+			glEnableVertexAttribArray(instance_loc);
+			glVertexAttribPointer(instance_loc, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void *)offset);
+			glVertexAttribDivisor(instance_loc, 1);
+			// back to the mesh buffer the bind cache has on record
+			glBindBuffer(GL_ARRAY_BUFFER, bound_vbo);
 			gl_has_errors();
 
-			const std::string &scale = "scales[" + std::to_string(i) + "]";
-			GLint scale_loc = glGetUniformLocation(currProgram, scale.c_str());
+			glDrawElementsInstanced(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, 0, (GLsizei)particle_instances.size());
 
-			glUniform1f(scale_loc, p.time_elapsed_ms / p.lifespan_ms);
-			
-			gl_has_errors();
+			glVertexAttribDivisor(instance_loc, 0);
+			glDisableVertexAttribArray(instance_loc);
 		}
-		glDrawElementsInstanced(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, 0, registry.emitters.get(entity).particles.size());
-		
 	}
 	else
 	{
@@ -343,7 +380,7 @@ void RenderSystem::drawScreenSpaceObject(Entity entity)
 	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
 	const GLuint program = (GLuint)effects[used_effect_enum];
 
-	glUseProgram(program);
+	useProgram(program);
 	gl_has_errors();
 
 	assert(render_request.used_geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
@@ -351,8 +388,7 @@ void RenderSystem::drawScreenSpaceObject(Entity entity)
 	const GLuint ibo = index_buffers[(GLuint)render_request.used_geometry];
 
 	// Setting vertex and index buffers
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	bindGeometry(vbo, ibo);
 	gl_has_errors();
 
 	if (render_request.used_effect == EFFECT_ASSET_ID::TEXTURED)
@@ -412,9 +448,9 @@ void RenderSystem::drawScreenSpaceObject(Entity entity)
 		if (render_request.used_sprite == SPRITE_ASSET_ID::SPRITE_COUNT || render_request.sprite_index == -1)
 		{
 			texture_id =
-				texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
+				textures.use(registry.renderRequests.get(entity).used_texture);
 
-			glBindTexture(GL_TEXTURE_2D, texture_id);
+			bindTexture(texture_id);
 			gl_has_errors();
 
 			GLuint uv_offset_loc = glGetUniformLocation(program, "uv_offset");
@@ -425,19 +461,18 @@ void RenderSystem::drawScreenSpaceObject(Entity entity)
 		}
 		else
 		{
-			texture_id = texture_gl_handles[(GLuint)sprite_sheets[registry.renderRequests.get(entity).used_sprite].texture_id];
+			texture_id = textures.use(sprite_table[(int)render_request.used_sprite].texture);
 
-			glBindTexture(GL_TEXTURE_2D, texture_id);
+			bindTexture(texture_id);
 			gl_has_errors();
 
-			float u0, v0, u1, v1;
-			getUVCoordinates(registry.renderRequests.get(entity).used_sprite, registry.renderRequests.get(entity).sprite_index, u0, v0, u1, v1);
+			const SpriteUV &uv = getSpriteUV(render_request.used_sprite, render_request.sprite_index);
 
 			GLuint uv_offset_loc = glGetUniformLocation(program, "uv_offset");
-			glUniform2f(uv_offset_loc, u0, v0);
+			glUniform2f(uv_offset_loc, uv.offset.x, uv.offset.y);
 
 			GLuint uv_scale_loc = glGetUniformLocation(program, "uv_scale");
-			glUniform2f(uv_scale_loc, (u1 - u0), (v1 - v0));
+			glUniform2f(uv_scale_loc, uv.scale.x, uv.scale.y);
 		}
 	}
 	else if (render_request.used_effect == EFFECT_ASSET_ID::COLOURED)
@@ -469,6 +504,191 @@ void RenderSystem::drawScreenSpaceObject(Entity entity)
 	gl_has_errors();
 }
 
+// Health bars of every enemy on screen in one instanced draw, built straight from their Health and Motion each frame
+void RenderSystem::drawHealthBars(const mat3 &projection)
+{
+	const float BAR_WIDTH = 100.f;
+	const float BAR_HEIGHT = 10.f;
+	const vec3 ENEMY_BAR_COLOR = {0.f, 0.5f, 0.f};
+	const vec3 BOSS_BAR_COLOR = {0.8f, 0.f, 0.f};
+
+	vec2 camera_position = registry.motions.get(registry.cameras.entities.front()).position;
+	vec2 screen_half = {window_width_px / 2.f, window_height_px / 2.f};
+
+	health_bar_instances.clear();
+	for (Entity entity : registry.deadlys.entities)
+	{
+		// swarm members and projectiles don't show their health
+		if (registry.swarms.has(entity) || registry.projectiles.has(entity) || !registry.healths.has(entity) || !registry.motions.has(entity))
+		{
+			continue;
+		}
+
+		const Health &health = registry.healths.get(entity);
+		const Motion &motion = registry.motions.get(entity);
+		vec2 centre = {motion.position.x, motion.position.y - abs(motion.scale.y) * 0.75f};
+		if (abs(centre.x - camera_position.x) > screen_half.x + BAR_WIDTH / 2.f ||
+			abs(centre.y - camera_position.y) > screen_half.y + BAR_HEIGHT / 2.f)
+		{
+			continue;
+		}
+
+		float fill = clamp(health.hit_points / health.max_hp, 0.f, 1.f);
+		vec3 color = registry.bosses.has(entity) ? BOSS_BAR_COLOR : ENEMY_BAR_COLOR;
+		health_bar_instances.push_back({vec4(centre, BAR_WIDTH, fill), color});
+	}
+
+	if (health_bar_instances.empty())
+	{
+		return;
+	}
+
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::HP_BAR];
+	useProgram(program);
+	bindGeometry(vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::DEBUG_LINE], index_buffers[(GLuint)GEOMETRY_BUFFER_ID::DEBUG_LINE]);
+	gl_has_errors();
+
+	GLint in_position_loc = glGetAttribLocation(program, "in_position");
+	glEnableVertexAttribArray(in_position_loc);
+	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)0);
+
+	size_t offset = stream_buffer.write(health_bar_instances.data(), health_bar_instances.size() * sizeof(HealthBarInstance), 4 * sizeof(float));
+
+	GLint bar_loc = glGetAttribLocation(program, "in_bar");
+	GLint bar_color_loc = glGetAttribLocation(program, "in_bar_color");
+	glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.handle());
+	glEnableVertexAttribArray(bar_loc);
+	glVertexAttribPointer(bar_loc, 4, GL_FLOAT, GL_FALSE, sizeof(HealthBarInstance), (void *)offset);
+	glVertexAttribDivisor(bar_loc, 1);
+	glEnableVertexAttribArray(bar_color_loc);
+	glVertexAttribPointer(bar_color_loc, 3, GL_FLOAT, GL_FALSE, sizeof(HealthBarInstance), (void *)(offset + offsetof(HealthBarInstance, color)));
+	glVertexAttribDivisor(bar_color_loc, 1);
+	// back to the mesh buffer the bind cache has on record
+	glBindBuffer(GL_ARRAY_BUFFER, bound_vbo);
+	gl_has_errors();
+
+	GLuint projection_loc = glGetUniformLocation(program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	GLuint bar_height_loc = glGetUniformLocation(program, "bar_height");
+	glUniform1f(bar_height_loc, BAR_HEIGHT);
+	gl_has_errors();
+
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, (GLsizei)health_bar_instances.size());
+
+	glVertexAttribDivisor(bar_loc, 0);
+	glDisableVertexAttribArray(bar_loc);
+	glVertexAttribDivisor(bar_color_loc, 0);
+	glDisableVertexAttribArray(bar_color_loc);
+	gl_has_errors();
+}
+
+// Every debug line of the frame in a single draw
+void RenderSystem::drawDebugLines(const mat3 &projection)
+{
+	const std::vector<DebugDraw::Vertex> &lines = debug_draw.lines();
+	if (lines.empty())
+	{
+		return;
+	}
+
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::DEBUG_DRAW];
+	useProgram(program);
+
+	size_t offset = stream_buffer.write(lines.data(), lines.size() * sizeof(DebugDraw::Vertex), 4 * sizeof(float));
+
+	GLint in_position_loc = glGetAttribLocation(program, "in_position");
+	GLint in_color_loc = glGetAttribLocation(program, "in_color");
+	glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.handle());
+	glEnableVertexAttribArray(in_position_loc);
+	glVertexAttribPointer(in_position_loc, 2, GL_FLOAT, GL_FALSE, sizeof(DebugDraw::Vertex), (void *)offset);
+	glEnableVertexAttribArray(in_color_loc);
+	glVertexAttribPointer(in_color_loc, 3, GL_FLOAT, GL_FALSE, sizeof(DebugDraw::Vertex), (void *)(offset + offsetof(DebugDraw::Vertex, color)));
+	// back to the mesh buffer the bind cache has on record
+	glBindBuffer(GL_ARRAY_BUFFER, bound_vbo);
+	gl_has_errors();
+
+	GLuint projection_loc = glGetUniformLocation(program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	gl_has_errors();
+
+	glDrawArrays(GL_LINES, 0, (GLsizei)lines.size());
+	gl_has_errors();
+}
+
+// damage number instance buffer never starts out smaller than this
+const size_t DAMAGE_NUMBER_MIN_CAPACITY = 256;
+
+// Every damage number in one instanced draw, the shader animates them from the damage number clock
+// The instance buffer is only touched when numbers were added (appended) or dropped (rebuilt)
+void RenderSystem::drawDamageNumbers(const mat3 &projection)
+{
+	const std::vector<DamageDigit> &digits = damage_numbers.digits();
+	glBindBuffer(GL_ARRAY_BUFFER, damage_number_vbo);
+	if (damage_numbers.generation() != damage_number_generation || digits.size() > damage_number_capacity)
+	{
+		damage_number_generation = damage_numbers.generation();
+		if (digits.size() > damage_number_capacity)
+		{
+			damage_number_capacity = max(digits.size() * 2, DAMAGE_NUMBER_MIN_CAPACITY);
+			glBufferData(GL_ARRAY_BUFFER, damage_number_capacity * sizeof(DamageDigit), nullptr, GL_DYNAMIC_DRAW);
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, 0, digits.size() * sizeof(DamageDigit), digits.data());
+		damage_number_count = digits.size();
+	}
+	else if (digits.size() > damage_number_count)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, damage_number_count * sizeof(DamageDigit),
+						(digits.size() - damage_number_count) * sizeof(DamageDigit), digits.data() + damage_number_count);
+		damage_number_count = digits.size();
+	}
+	gl_has_errors();
+
+	if (digits.empty())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, bound_vbo);
+		return;
+	}
+
+	// drawn over the final image like the rest of the text, drawToScreen leaves blending off
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::DAMAGE_NUMBER];
+	useProgram(program);
+
+	GLint number_loc = glGetAttribLocation(program, "in_number");
+	GLint glyph_loc = glGetAttribLocation(program, "in_glyph");
+	glEnableVertexAttribArray(number_loc);
+	glVertexAttribPointer(number_loc, 4, GL_FLOAT, GL_FALSE, sizeof(DamageDigit), (void *)0);
+	glVertexAttribDivisor(number_loc, 1);
+	glEnableVertexAttribArray(glyph_loc);
+	glVertexAttribPointer(glyph_loc, 4, GL_FLOAT, GL_FALSE, sizeof(DamageDigit), (void *)offsetof(DamageDigit, pen_x));
+	glVertexAttribDivisor(glyph_loc, 1);
+	gl_has_errors();
+
+	bindGeometry(vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::DEBUG_LINE], index_buffers[(GLuint)GEOMETRY_BUFFER_ID::DEBUG_LINE]);
+	GLint in_position_loc = glGetAttribLocation(program, "in_position");
+	glEnableVertexAttribArray(in_position_loc);
+	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)0);
+
+	glActiveTexture(GL_TEXTURE0);
+	bindTexture(font_atlas);
+
+	glUniformMatrix3fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, (float *)&projection);
+	glUniform1f(glGetUniformLocation(program, "time"), damage_numbers.now());
+	glUniform1f(glGetUniformLocation(program, "lifetime"), DamageNumbers::LIFETIME_MS);
+	glUniform4fv(glGetUniformLocation(program, "digit_uv"), 10, (float *)digit_uvs.data());
+	glUniform4fv(glGetUniformLocation(program, "digit_box"), 10, (float *)digit_boxes.data());
+	gl_has_errors();
+
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, (GLsizei)digits.size());
+
+	glVertexAttribDivisor(number_loc, 0);
+	glDisableVertexAttribArray(number_loc);
+	glVertexAttribDivisor(glyph_loc, 0);
+	glDisableVertexAttribArray(glyph_loc);
+	gl_has_errors();
+}
+
 void RenderSystem::renderText()
 {
 	glEnable(GL_BLEND);
@@ -477,92 +697,102 @@ void RenderSystem::renderText()
 	glUseProgram(m_font_shaderProgram);
 	gl_has_errors();
 
-	std::vector<DamageIndicator> damageIndicators;
+	GLint transformLoc =
+		glGetUniformLocation(m_font_shaderProgram, "transform");
+	glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+	glBindTexture(GL_TEXTURE_2D, font_atlas);
+	gl_has_errors();
 
-	for (Entity &entity : registry.damageIndicators.entities)
+	for (Entity &entity : registry.texts.entities)
 	{
-		auto &damageIndicatorComponent = registry.damageIndicators.get(entity);
-		damageIndicators.push_back(damageIndicatorComponent);
+		Motion &motion_component = registry.motions.get(entity);
+		Text &text_component = registry.texts.get(entity);
+		renderString(text_component.content, motion_component.position.x, motion_component.position.y, text_component.scale, text_component.color, 1.f);
 	}
 
-	for (Entity &entity : registry.texts.entities)
+	// debug labels are placed in the world, text is drawn in screen pixels with y going up
+	if (!debug_draw.labels().empty())
 	{
-		Motion &motion_component = registry.motions.get(entity);
-		float x = motion_component.position.x;
-		float y = motion_component.position.y;
+		vec2 camera_position = registry.motions.get(registry.cameras.entities.front()).position;
+		for (const DebugDraw::Label &label : debug_draw.labels())
+		{
+			float x = label.position.x - camera_position.x + window_width_px / 2.f;
+			float y = window_height_px / 2.f - (label.position.y - camera_position.y);
+			renderString(label.content, x, y, label.scale, label.color, 1.f);
+		}
+	}
 
-		Text &text_component = registry.texts.get(entity);
-		glm::vec3 color = text_component.color;
-		std::string text = text_component.content;
-		float scale = text_component.scale;
+	glBindVertexArray(vao);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-		// Check if array contains entity
-		// if does: get shader uniform and set based on time
+void RenderSystem::renderString(const std::string &text, float x, float y, float scale, vec3 color, float opacity)
+{
+	if (text.empty())
+	{
+		return;
+	}
 
-		float opacity = 1.0f;
+	GLuint m_font_shaderProgram = effects[(GLuint)EFFECT_ASSET_ID::FONT];
+	GLint opacity_location = glGetUniformLocation(m_font_shaderProgram, "opacity");
+	glUniform1f(opacity_location, opacity);
+	gl_has_errors();
 
-		for (DamageIndicator dmg : damageIndicators)
-		{
-			if (entity == dmg.text)
-			{
-				opacity = dmg.time_elapsed_ms / dmg.time_total_ms;
-			}
-		}
+	// get shader uniforms
+	GLint textColor_location =
+		glGetUniformLocation(m_font_shaderProgram, "textColor");
+	glUniform3f(textColor_location, color.x, color.y, color.z);
+	gl_has_errors();
 
-		GLint opacity_location = glGetUniformLocation(m_font_shaderProgram, "opacity");
-		glUniform1f(opacity_location, opacity);
-		gl_has_errors();
+	// build the quads of every character, then upload them in one go
+	text_vertices.clear();
+	std::string::const_iterator c;
+	for (c = text.begin(); c != text.end(); c++)
+	{
+		const Character &ch = m_ftCharacters[*c];
 
-		// get shader uniforms
-		GLint textColor_location =
-			glGetUniformLocation(m_font_shaderProgram, "textColor");
-		glUniform3f(textColor_location, color.x, color.y, color.z);
-		gl_has_errors();
-		GLint transformLoc =
-			glGetUniformLocation(m_font_shaderProgram, "transform");
-		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-		gl_has_errors();
-		glBindVertexArray(m_font_vao);
-		gl_has_errors();
-		// iterate through all characters
-		std::string::const_iterator c;
-		for (c = text.begin(); c != text.end(); c++)
+		// blank glyphs have nothing to draw
+		if (ch.Size.x > 0)
 		{
-			Character ch = m_ftCharacters[*c];
-
 			float xpos = x + ch.Bearing.x * scale;
 			float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
 
 			float w = ch.Size.x * scale;
 			float h = ch.Size.y * scale;
-			// update VBO for each character
+			float u0 = ch.uv.x;
+			float v0 = ch.uv.y;
+			float u1 = ch.uv.x + ch.uv.z;
+			float v1 = ch.uv.y + ch.uv.w;
 			float vertices[6][4] = {
-				{xpos, ypos + h, 0.0f, 0.0f},
-				{xpos, ypos, 0.0f, 1.0f},
-				{xpos + w, ypos, 1.0f, 1.0f},
+				{xpos, ypos + h, u0, v0},
+				{xpos, ypos, u0, v1},
+				{xpos + w, ypos, u1, v1},
+
+				{xpos, ypos + h, u0, v0},
+				{xpos + w, ypos, u1, v1},
+				{xpos + w, ypos + h, u1, v0}};
+			text_vertices.insert(text_vertices.end(), &vertices[0][0], &vertices[0][0] + 6 * 4);
+		}
 
-				{xpos, ypos + h, 0.0f, 0.0f},
-				{xpos + w, ypos, 1.0f, 1.0f},
-				{xpos + w, ypos + h, 1.0f, 0.0f}};
+		// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+		x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+	}
+	if (text_vertices.empty())
+	{
+		return;
+	}
 
-			// render glyph texture over quad
-			glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+	size_t offset = stream_buffer.write(text_vertices.data(), text_vertices.size() * sizeof(float), 4 * sizeof(float));
 
-			// update content of VBO memory
-			glBindBuffer(GL_ARRAY_BUFFER, m_font_vbo);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-			gl_has_errors();
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			// render quad
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			gl_has_errors();
+	glBindVertexArray(m_font_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.handle());
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)offset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl_has_errors();
 
-			// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-			x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
-		}
-	}
-	glBindVertexArray(vao);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	// every glyph is in the font atlas, so the whole string is one draw
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(text_vertices.size() / 4));
+	gl_has_errors();
 }
 
 // draw the intermediate texture to the screen, with some distortion to simulate
@@ -668,6 +898,7 @@ void RenderSystem::draw()
 	glClearColor(GLfloat(26 / 255.0), GLfloat(20 / 255.0), GLfloat(15 / 255.0), 1.0);
 	glClearDepth(10.f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	stream_buffer.begin_frame();
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_DEPTH_TEST); // native OpenGL does not work with a depth buffer
@@ -679,68 +910,130 @@ void RenderSystem::draw()
 	vec2 camera_position = registry.motions.get(camera_entity).position;
 	mat3 projection_2D = createPlayerProjectionMatrix(camera_position);
 	// mat3 projection_2D = createProjectionMatrix();
-	// Draw all textured meshes that have a position and size component
-	std::vector<Entity> uiEntities_1;
-	std::vector<Entity> uiEntities_2;
-
-	// separate by layer - visible_layers establishes order, inclusion
-	std::vector<RENDER_LAYER> visible_layers = {RENDER_LAYER::FLOOR, RENDER_LAYER::FLOOR_DECOR, RENDER_LAYER::CREATURES, RENDER_LAYER::OBSTACLES, RENDER_LAYER::EFFECTS, RENDER_LAYER::DEFAULT_LAYER, RENDER_LAYER::UI_LAYER_1, RENDER_LAYER::UI_LAYER_2};
 
-	for (RENDER_LAYER layer : visible_layers)
+	// One key per draw, sorting them gives the draw order: stage, then request index inside the stage
+	// the GL state in the key never reorders draws, the bind cache skips the binds consecutive draws share
+	auto &render_requests = registry.renderRequests;
+	draw_keys.clear();
+	draw_stats = DrawStats();
+	for (uint32_t i = 0; i < render_requests.size(); i++)
 	{
-		for (Entity entity : registry.renderRequests.entities)
+		Entity entity = render_requests.entities[i];
+		const RenderRequest &render_request = render_requests.components[i];
+
+		if (registry.userInterfaces.has(entity))
 		{
-			if (registry.userInterfaces.has(entity) && layer == RENDER_LAYER::UI_LAYER_1)
-			{
-				if (!(registry.renderRequests.get(entity).layer == RENDER_LAYER::UI_LAYER_2))
-				{
-					uiEntities_1.push_back(entity);
-					continue;
-				}
-			}
-			if (registry.userInterfaces.has(entity) && layer == RENDER_LAYER::UI_LAYER_2)
-			{ // layer 2 of ui is explicitly stated in RR
-				if (registry.renderRequests.get(entity).layer == layer)
-				{
-					uiEntities_2.push_back(entity);
-					continue;
-				}
-			}
-			if (registry.renderRequests.get(entity).layer != layer)
+			// UI is drawn in screen space after the world, layer 2 over everything else
+			int stage = (render_request.layer == RENDER_LAYER::UI_LAYER_2) ? draw_key::SCREEN_SPACE_UI_2 : draw_key::SCREEN_SPACE_UI_1;
+			draw_keys.push_back(make_draw_key(stage, render_request, i));
+
+			// UI on a world layer is also drawn with the world
+			if (render_request.layer == RENDER_LAYER::UI_LAYER_1 || render_request.layer == RENDER_LAYER::UI_LAYER_2)
 			{
 				continue;
 			}
+		}
 
-			if (!registry.motions.has(entity))
-				continue;
+		if (!registry.motions.has(entity) || registry.texts.has(entity))
+		{
+			continue;
+		}
 
-			if (registry.texts.has(entity))
-				continue;
-			// Note, its not very efficient to access elements indirectly via the entity
-			// albeit iterating through all Sprites in sequence. A good point to optimize
-			drawTexturedMesh(entity, projection_2D);
+		// particles are drawn around the emitter rather than inside its box, so emitters are never culled
+		if (!registry.emitters.has(entity) && !isOnScreen(entity, camera_position))
+		{
+			draw_stats.culled++;
+			continue;
 		}
+		draw_keys.push_back(make_draw_key(world_stage(render_request.layer), render_request, i));
 	}
+	radix_sort_keys(draw_keys, draw_keys_scratch);
+	draw_stats.drawn = (int)draw_keys.size();
 
-	for (Entity entity : uiEntities_1)
+	resetBoundState();
+	// health bars go on top of the default layer, under any UI
+	bool health_bars_drawn = false;
+	for (uint64_t key : draw_keys)
 	{
-		drawScreenSpaceObject(entity);
-	}
+		if (!health_bars_drawn && draw_key_stage(key) > world_stage(RENDER_LAYER::DEFAULT_LAYER))
+		{
+			drawHealthBars(projection_2D);
+			health_bars_drawn = true;
+		}
 
-	for (Entity entity : uiEntities_2)
+		Entity entity = render_requests.entities[draw_key_sequence(key)];
+		if (draw_key_stage(key) >= draw_key::SCREEN_SPACE_UI_1)
+		{
+			drawScreenSpaceObject(entity);
+		}
+		else
+		{
+			drawTexturedMesh(entity, projection_2D);
+		}
+	}
+	if (!health_bars_drawn)
 	{
-		drawScreenSpaceObject(entity);
+		drawHealthBars(projection_2D);
 	}
+	drawDebugLines(projection_2D);
 
 	// Truely render to the screen
 	drawToScreen();
 
+	// drawToScreen bypasses the bind cache
+	resetBoundState();
+	drawDamageNumbers(projection_2D);
 	renderText();
+	// everything streamed this frame has been drawn
+	stream_buffer.end_frame();
+	// upload the next preloaded texture, evict cold ones over budget
+	textures.end_frame();
 	// flicker-free display with a double buffer
 	glfwSwapBuffers(window);
 	gl_has_errors();
 }
 
+void RenderSystem::useProgram(GLuint program)
+{
+	if (program != bound_program)
+	{
+		glUseProgram(program);
+		bound_program = program;
+	}
+}
+
+void RenderSystem::bindGeometry(GLuint vbo, GLuint ibo)
+{
+	if (vbo != bound_vbo)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		bound_vbo = vbo;
+	}
+	if (ibo != bound_ibo)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+		bound_ibo = ibo;
+	}
+}
+
+void RenderSystem::bindTexture(GLuint texture)
+{
+	if (texture != bound_texture)
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+		bound_texture = texture;
+	}
+}
+
+// other passes bind their own state, so nothing bound before this point can be trusted
+void RenderSystem::resetBoundState()
+{
+	bound_program = 0;
+	bound_vbo = 0;
+	bound_ibo = 0;
+	bound_texture = 0;
+}
+
 mat3 RenderSystem::createPlayerProjectionMatrix(vec2 position)
 {
 	// Fake projection matrix, scales with respect to window coordinates
@@ -775,6 +1068,14 @@ mat3 RenderSystem::createProjectionMatrix()
 	return {{sx, 0.f, 0.f}, {0.f, sy, 0.f}, {tx, ty, 1.f}};
 }
 
+const SpriteUV &RenderSystem::getSpriteUV(SPRITE_ASSET_ID sid, int spriteIndex) const
+{
+	const SpriteSheetEntry &entry = sprite_table[(int)sid];
+	assert(entry.frame_count > 0 && spriteIndex >= 0);
+	// indices past the last row used to wrap around the texture, keep doing that
+	return sprite_uvs[entry.first_frame + (spriteIndex % entry.frame_count)];
+}
+
 void RenderSystem::getUVCoordinates(SPRITE_ASSET_ID sid, int spriteIndex, float &u0, float &v0, float &u1, float &v1)
 {
 	SpriteSheetInfo info = sprite_sheets[sid];
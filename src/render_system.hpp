@@ -7,6 +7,8 @@
 #include "common.hpp"
 #include "components.hpp"
 #include "tiny_ecs.hpp"
+#include "stream_buffer.hpp"
+#include "texture_cache.hpp"
 #include <map>
 // fonts
 #include <ft2build.h>
@@ -18,14 +20,17 @@ class RenderSystem
 {
 	/**
 	 * The following arrays store the assets the game will use. They are loaded
-	 * at initialization and are assumed to not be modified by the render loop.
+	 * at initialization and are assumed to not be modified by the render loop
+	 * (textures only get their GL names up front, see texture_cache.hpp).
 	 *
 	 * Whenever possible, add to these lists instead of creating dynamic state
 	 * it is easier to debug and faster to execute for the computer.
 	 */
 	std::array<GLuint, texture_count> texture_gl_handles;
-	std::array<ivec2, texture_count> texture_dimensions;
 	std::unordered_map<SPRITE_ASSET_ID, SpriteSheetInfo> sprite_sheets;
+	// sprite_sheets flattened once textures are loaded, indexed by SPRITE_ASSET_ID
+	std::array<SpriteSheetEntry, sprite_count> sprite_table;
+	std::vector<SpriteUV> sprite_uvs;
 
 	// Make sure these paths remain in sync with the associated enumerators.
 	// Associated id with .obj path
@@ -118,14 +123,18 @@ class RenderSystem
 		shader_path("water"),
 		shader_path("font"),
 		shader_path("dash"),
-		shader_path("smoke")};
+		shader_path("smoke"),
+		shader_path("hpbar"),
+		shader_path("debug"),
+		shader_path("damage_number")};
 
 	std::array<GLuint, geometry_count> vertex_buffers;
 	std::array<GLuint, geometry_count> index_buffers;
 	std::array<Mesh, geometry_count> meshes;
 	std::map<char, Character> m_ftCharacters;
+	// signed distance fields of every printable glyph, all text sizes are drawn from it (see fontInit)
+	GLuint font_atlas = 0;
 	GLuint m_font_vao;
-	GLuint m_font_vbo;
 	GLuint vao;
 	GLuint vbo;
 	FT_Face face;
@@ -134,6 +143,7 @@ public:
 	// Initialize the window
 	bool init(GLFWwindow *window);
 	bool fontInit(const std::string &font_filename, unsigned int font_default_size);
+	void initializeDigitGlyphs();
 
 	template <class T>
 	void bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices);
@@ -143,8 +153,14 @@ public:
 	void initializeSpriteSheets();
 
 	void getUVCoordinates(SPRITE_ASSET_ID sid, int spriteIndex, float &u0, float &v0, float &u1, float &v1);
+	void compileSpriteSheets();
+	const SpriteUV &getSpriteUV(SPRITE_ASSET_ID sid, int spriteIndex) const;
 
 	void initializeGlTextures();
+	// Makes the textures state (and level, in game) needs the preload set, so they are uploaded before the first frame that draws them
+	void preloadTextures(GameState state, int level);
+	void setTextureBudget(size_t bytes) { textures.set_budget(bytes); }
+	const TextureCache &getTextureCache() const { return textures; }
 
 	void initializeGlEffects();
 
@@ -166,12 +182,68 @@ public:
 	mat3 createProjectionMatrix();
 	mat3 createPlayerProjectionMatrix(vec2 position);
 
+	// Draws made and world sprites skipped for being off screen in the last frame
+	struct DrawStats
+	{
+		int drawn = 0;
+		int culled = 0;
+	};
+	const DrawStats &getDrawStats() const { return draw_stats; }
+
 private:
 	// Internal drawing functions for each entity type
 	void drawTexturedMesh(Entity entity, const mat3 &projection);
 	void drawScreenSpaceObject(Entity entity);
+	void drawHealthBars(const mat3 &projection);
+	void drawDebugLines(const mat3 &projection);
+	void drawDamageNumbers(const mat3 &projection);
 	void drawToScreen();
 	void renderText();
+	// draws one string at (x, y) in screen pixels, the font program must be in use
+	void renderString(const std::string &text, float x, float y, float scale, vec3 color, float opacity);
+
+	vec2 spriteScale(Entity entity);
+	bool isOnScreen(Entity entity, const vec2 &camera_position);
+	DrawStats draw_stats;
+
+	// Binds only when the draw before used something else, the cache is reset at the start of every frame
+	void useProgram(GLuint program);
+	void bindGeometry(GLuint vbo, GLuint ibo);
+	void bindTexture(GLuint texture);
+	void resetBoundState();
+
+	// per frame vertex / instance data (text quads, smoke particles, health bars)
+	GlStreamBackend stream_backend;
+	StreamBuffer stream_buffer;
+
+	GlTextureUploader texture_uploader;
+	TextureCache textures;
+	std::vector<float> text_vertices;
+	std::vector<vec3> particle_instances;
+	struct HealthBarInstance
+	{
+		// centre, full width, fill fraction
+		vec4 bar;
+		vec3 color;
+	};
+	std::vector<HealthBarInstance> health_bar_instances;
+
+	// damage number instances (damage_indicator_system.hpp), mirrors what has been uploaded so far
+	GLuint damage_number_vbo = 0;
+	size_t damage_number_capacity = 0;
+	size_t damage_number_count = 0;
+	uint32_t damage_number_generation = 0;
+	// each digit's rect in the font atlas (u, v, width, height) and box (size, bearing) in pixels
+	std::array<vec4, 10> digit_uvs;
+	std::array<vec4, 10> digit_boxes;
+
+	// draw list of the frame being drawn, kept around so it doesn't reallocate
+	std::vector<uint64_t> draw_keys;
+	std::vector<uint64_t> draw_keys_scratch;
+	GLuint bound_program = 0;
+	GLuint bound_vbo = 0;
+	GLuint bound_ibo = 0;
+	GLuint bound_texture = 0;
 
 	// Window handle
 	GLFWwindow *window;
@@ -1,13 +1,16 @@
 // internal
 #include "render_system.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <fstream>
 
 #include "../ext/stb_image/stb_image.h"
 
 // This creates circular header inclusion, that is quite bad.
 #include "tiny_ecs_registry.hpp"
+#include "damage_indicator_system.hpp"
 
 // stlib
 #include <iostream>
@@ -21,6 +24,16 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+// bytes of text / particle data a frame can stream before the stream buffer has to grow
+const size_t STREAM_SEGMENT_SIZE = 256 * 1024;
+
+// how far (in pixels at the rasterised size) a glyph's distance field reaches past its edge, and the font atlas width
+const int FONT_SDF_SPREAD = 8;
+const int FONT_ATLAS_WIDTH = 512;
+
+// texture memory kept resident before cold textures start being evicted (floor.png alone is ~100MB as RGBA)
+const size_t TEXTURE_MEMORY_BUDGET = 128 * 1024 * 1024;
+
 // World initialization
 bool RenderSystem::init(GLFWwindow *window_arg)
 {
@@ -67,11 +80,104 @@ bool RenderSystem::init(GLFWwindow *window_arg)
 	initializeGlEffects();
 	initializeGlGeometryBuffers();
 	initializeSpriteSheets();
+	stream_buffer.init(&stream_backend, STREAM_SEGMENT_SIZE);
 	fontInit(PROJECT_SOURCE_DIR + std::string("data/fonts/Kenney_Pixel.ttf"), 74);
 
 	return true;
 }
 
+// Squared distance from every sample to the nearest zero sample along one row or column, in place
+// (Felzenszwalb and Huttenlocher's lower envelope of parabolas, exact and linear in n)
+static void distanceTransform1D(float *f, int n, int stride, std::vector<float> &d, std::vector<int> &v, std::vector<float> &z)
+{
+	const float FAR = 1e20f;
+	int k = 0;
+	v[0] = 0;
+	z[0] = -FAR;
+	z[1] = FAR;
+	for (int q = 1; q < n; q++)
+	{
+		// where the parabola rooted at q overtakes the lowest one so far, drop those it hides completely
+		float s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2.f * (q - v[k]));
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2.f * (q - v[k]));
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = FAR;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q)
+		{
+			k++;
+		}
+		d[q] = (float)(q - v[k]) * (q - v[k]) + f[v[k] * stride];
+	}
+	for (int q = 0; q < n; q++)
+	{
+		f[q * stride] = d[q];
+	}
+}
+
+// Squared distance from every pixel to the nearest pixel where target is true, over a w x h grid
+static void distanceTransform(std::vector<float> &grid, int w, int h)
+{
+	int n = max(w, h);
+	std::vector<float> d(n);
+	std::vector<int> v(n);
+	std::vector<float> z(n + 1);
+	for (int x = 0; x < w; x++)
+	{
+		distanceTransform1D(&grid[x], h, w, d, v, z);
+	}
+	for (int y = 0; y < h; y++)
+	{
+		distanceTransform1D(&grid[y * w], w, 1, d, v, z);
+	}
+}
+
+// Signed distance field of a rendered glyph, padded by spread on every side
+// 128 is the glyph's edge, 255 spread pixels inside it and 0 spread pixels outside
+static void glyphDistanceField(const FT_Bitmap &bitmap, int spread, std::vector<uint8_t> &out)
+{
+	const float FAR = 1e20f;
+	int w = (int)bitmap.width + 2 * spread;
+	int h = (int)bitmap.rows + 2 * spread;
+	std::vector<bool> inside(w * h, false);
+	for (int y = 0; y < (int)bitmap.rows; y++)
+	{
+		for (int x = 0; x < (int)bitmap.width; x++)
+		{
+			inside[(y + spread) * w + x + spread] = bitmap.buffer[y * bitmap.pitch + x] >= 128;
+		}
+	}
+
+	std::vector<float> to_inside(w * h);
+	std::vector<float> to_outside(w * h);
+	for (int i = 0; i < w * h; i++)
+	{
+		to_inside[i] = inside[i] ? 0.f : FAR;
+		to_outside[i] = inside[i] ? FAR : 0.f;
+	}
+	distanceTransform(to_inside, w, h);
+	distanceTransform(to_outside, w, h);
+
+	out.resize(w * h);
+	for (int i = 0; i < w * h; i++)
+	{
+		// pixel centres are half a pixel from the edge between an inside and an outside pixel
+		float distance = inside[i] ? sqrtf(to_outside[i]) - 0.5f : 0.5f - sqrtf(to_inside[i]);
+		float value = 0.5f + distance / (2.f * spread);
+		out[i] = (uint8_t)(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+	}
+}
+
 bool RenderSystem::fontInit(const std::string &font_filename, unsigned int font_default_size)
 {
 	// enable blending or you will just get solid boxes instead of text
@@ -80,7 +186,6 @@ bool RenderSystem::fontInit(const std::string &font_filename, unsigned int font_
 
 	// font buffer setup
 	glGenVertexArrays(1, &m_font_vao);
-	glGenBuffers(1, &m_font_vbo);
 
 	// apply orthographic projection matrix for font, i.e., screen space
 	GLuint m_font_shader_program = effects[(GLuint)EFFECT_ASSET_ID::FONT];
@@ -114,8 +219,13 @@ bool RenderSystem::fontInit(const std::string &font_filename, unsigned int font_
 	// disable byte-alignment restriction in OpenGL
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-	// load each of the chars - note only first 128 ASCII chars
-	for (unsigned char c = (unsigned char)0; c < (unsigned char)128; c++)
+	// turn the printable ASCII glyphs into distance fields and pack them in rows into one atlas,
+	// the fields scale cleanly so every Text::scale is drawn from this one size
+	std::vector<std::vector<uint8_t>> glyph_fields(128);
+	std::vector<ivec2> glyph_positions(128);
+	ivec2 pen = {0, 0};
+	int row_height = 0;
+	for (unsigned char c = ' '; c < 127; c++)
 	{
 		// load character glyph
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
@@ -124,84 +234,174 @@ bool RenderSystem::fontInit(const std::string &font_filename, unsigned int font_
 			continue;
 		}
 
-		// generate texture
-		unsigned int texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-
-
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			face->glyph->bitmap.width,
-			face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			face->glyph->bitmap.buffer);
-
-		// set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// now store character for later use
-		Character character = {
-			texture,
-			glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-			glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-			static_cast<unsigned int>(face->glyph->advance.x),
-			(char)c};
-		m_ftCharacters.insert(std::pair<char, Character>(c, character));
+		const FT_GlyphSlot glyph = face->glyph;
+		Character character;
+		character.uv = {0.f, 0.f, 0.f, 0.f};
+		character.Size = {0, 0};
+		character.Bearing = {glyph->bitmap_left, glyph->bitmap_top};
+		character.Advance = static_cast<unsigned int>(glyph->advance.x);
+		character.character = (char)c;
+
+		// blank glyphs (space) only advance the pen
+		if (glyph->bitmap.width > 0 && glyph->bitmap.rows > 0)
+		{
+			ivec2 size = {(int)glyph->bitmap.width + 2 * FONT_SDF_SPREAD, (int)glyph->bitmap.rows + 2 * FONT_SDF_SPREAD};
+			glyphDistanceField(glyph->bitmap, FONT_SDF_SPREAD, glyph_fields[c]);
+
+			if (pen.x + size.x > FONT_ATLAS_WIDTH)
+			{
+				pen = {0, pen.y + row_height + 1};
+				row_height = 0;
+			}
+			glyph_positions[c] = pen;
+			pen.x += size.x + 1;
+			row_height = max(row_height, size.y);
+
+			character.Size = size;
+			character.Bearing += ivec2(-FONT_SDF_SPREAD, FONT_SDF_SPREAD);
+		}
+		m_ftCharacters[(char)c] = character;
 	}
+
+	int atlas_height = pen.y + row_height;
+	std::vector<uint8_t> atlas(FONT_ATLAS_WIDTH * atlas_height, 0);
+	for (auto &entry : m_ftCharacters)
+	{
+		Character &character = entry.second;
+		unsigned char c = (unsigned char)entry.first;
+		if (character.Size.x == 0)
+		{
+			continue;
+		}
+		ivec2 position = glyph_positions[c];
+		for (int y = 0; y < character.Size.y; y++)
+		{
+			std::copy_n(&glyph_fields[c][y * character.Size.x], character.Size.x, &atlas[(position.y + y) * FONT_ATLAS_WIDTH + position.x]);
+		}
+		character.uv = {(float)position.x / FONT_ATLAS_WIDTH, (float)position.y / atlas_height,
+						(float)character.Size.x / FONT_ATLAS_WIDTH, (float)character.Size.y / atlas_height};
+	}
+
+	glGenTextures(1, &font_atlas);
+	glBindTexture(GL_TEXTURE_2D, font_atlas);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, FONT_ATLAS_WIDTH, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// the shader thresholds the interpolated distance, so linear filtering is what keeps edges smooth when scaled
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glBindTexture(GL_TEXTURE_2D, 0);
 
+	initializeDigitGlyphs();
+
 	// clean up
 	FT_Done_Face(face);
 	FT_Done_FreeType(ft);
 
-	// bind buffers
+	// glyph quads are streamed in when text is drawn, which also points attribute 0 at them
 	glBindVertexArray(m_font_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, m_font_vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
 
 	// release buffers
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(vao);
 	gl_has_errors();
 	return true;
 }
 
+// The damage numbers draw their digits out of the font atlas, all at once, so they need each digit's rect and box up front
+void RenderSystem::initializeDigitGlyphs()
+{
+	float advances[10];
+	for (int digit = 0; digit < 10; digit++)
+	{
+		const Character &ch = m_ftCharacters[(char)('0' + digit)];
+		digit_uvs[digit] = ch.uv;
+		digit_boxes[digit] = {(float)ch.Size.x, (float)ch.Size.y, (float)ch.Bearing.x, (float)ch.Bearing.y};
+		advances[digit] = (float)(ch.Advance >> 6);
+	}
+	damage_numbers.set_digit_advances(advances);
+
+	glGenBuffers(1, &damage_number_vbo);
+	gl_has_errors();
+}
+
 void RenderSystem::initializeGlTextures()
 {
+	// only the names, images are uploaded when first drawn or preloaded
 	glGenTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
+	textures.init(&texture_uploader, texture_gl_handles.data(), texture_paths.data(), TEXTURE_MEMORY_BUDGET);
+	gl_has_errors();
+}
 
-	for (uint i = 0; i < texture_paths.size(); i++)
+void RenderSystem::preloadTextures(GameState state, int level)
+{
+	static const TEXTURE_ASSET_ID start_set[] = {
+		TEXTURE_ASSET_ID::START_SCREEN, TEXTURE_ASSET_ID::TITLE,
+		// the level select is the only way out of the start screen
+		TEXTURE_ASSET_ID::MENU_SCREEN, TEXTURE_ASSET_ID::LEVEL_BUTTON, TEXTURE_ASSET_ID::EXIT_BUTTON};
+	static const TEXTURE_ASSET_ID menu_set[] = {
+		TEXTURE_ASSET_ID::MENU_SCREEN, TEXTURE_ASSET_ID::LEVEL_BUTTON, TEXTURE_ASSET_ID::EXIT_BUTTON, TEXTURE_ASSET_ID::ELEVATOR_DISPLAY,
+		// picking a level goes straight into the game, the floor is the slowest texture to upload
+		TEXTURE_ASSET_ID::FLOOR, TEXTURE_ASSET_ID::WALL, TEXTURE_ASSET_ID::INNER_WALL, TEXTURE_ASSET_ID::PLAYERS};
+	static const TEXTURE_ASSET_ID game_set[] = {
+		TEXTURE_ASSET_ID::FLOOR, TEXTURE_ASSET_ID::WALL, TEXTURE_ASSET_ID::INNER_WALL, TEXTURE_ASSET_ID::PLAYERS,
+		TEXTURE_ASSET_ID::HP_BAR, TEXTURE_ASSET_ID::STAMINA_BAR, TEXTURE_ASSET_ID::BARS, TEXTURE_ASSET_ID::HEART,
+		TEXTURE_ASSET_ID::SLASH, TEXTURE_ASSET_ID::DASH, TEXTURE_ASSET_ID::SMOKE_PARTICLE, TEXTURE_ASSET_ID::COINS,
+		TEXTURE_ASSET_ID::POWERUP, TEXTURE_ASSET_ID::BEETLE, TEXTURE_ASSET_ID::DOOR,
+		TEXTURE_ASSET_ID::CARD, TEXTURE_ASSET_ID::UPGRADE_ICONS, TEXTURE_ASSET_ID::LEVELUP_CONFIRM, TEXTURE_ASSET_ID::DIALOGUE_BOX,
+		TEXTURE_ASSET_ID::SKELETON, TEXTURE_ASSET_ID::SLIME, TEXTURE_ASSET_ID::RANGED_ENEMY, TEXTURE_ASSET_ID::RANGED_PROJECTILE,
+		TEXTURE_ASSET_ID::HOMING_ENEMY, TEXTURE_ASSET_ID::HOMING_PROJECTILE, TEXTURE_ASSET_ID::DASHING_ENEMY, TEXTURE_ASSET_ID::SLOWING_ENEMY,
+		// dying shows the game over screen right away
+		TEXTURE_ASSET_ID::GAME_OVER_SCREEN};
+	static const TEXTURE_ASSET_ID tutorial_set[] = {
+		TEXTURE_ASSET_ID::WASD_KEYS, TEXTURE_ASSET_ID::DASH_KEYS, TEXTURE_ASSET_ID::ATTACK_CURSOR,
+		TEXTURE_ASSET_ID::INTERACT_KEY, TEXTURE_ASSET_ID::PAUSE_KEY, TEXTURE_ASSET_ID::TUTORIAL_TOGGLE_KEY};
+	static const TEXTURE_ASSET_ID final_level_set[] = {
+		TEXTURE_ASSET_ID::FINAL_BOSS, TEXTURE_ASSET_ID::FINAL_BOSS_ATTACK, TEXTURE_ASSET_ID::SIGIL, TEXTURE_ASSET_ID::PROGRESS_CIRCLE};
+	static const TEXTURE_ASSET_ID game_over_set[] = {
+		TEXTURE_ASSET_ID::GAME_OVER_SCREEN,
+		// restarting goes back into the level, giving up goes to the level select
+		TEXTURE_ASSET_ID::FLOOR, TEXTURE_ASSET_ID::WALL, TEXTURE_ASSET_ID::INNER_WALL, TEXTURE_ASSET_ID::PLAYERS,
+		TEXTURE_ASSET_ID::MENU_SCREEN, TEXTURE_ASSET_ID::LEVEL_BUTTON, TEXTURE_ASSET_ID::EXIT_BUTTON};
+
+	std::vector<TEXTURE_ASSET_ID> ids;
+	switch (state)
 	{
-		const std::string &path = texture_paths[i];
-		ivec2 &dimensions = texture_dimensions[i];
-
-		stbi_uc *data;
-		data = stbi_load(path.c_str(), &dimensions.x, &dimensions.y, NULL, 4);
-
-		if (data == NULL)
+	case START:
+		ids.assign(std::begin(start_set), std::end(start_set));
+		break;
+	case MENU:
+		ids.assign(std::begin(menu_set), std::end(menu_set));
+		break;
+	case GAME_OVER:
+		ids.assign(std::begin(game_over_set), std::end(game_over_set));
+		break;
+	case GAME:
+	case PAUSED:
+		ids.assign(std::begin(game_set), std::end(game_set));
+		if (level == 1)
 		{
-			const std::string message = "Could not load the file " + path + ".";
-			fprintf(stderr, "%s", message.c_str());
-			assert(false);
+			ids.insert(ids.end(), std::begin(tutorial_set), std::end(tutorial_set));
 		}
-		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		gl_has_errors();
-		stbi_image_free(data);
+		else if (level == 5)
+		{
+			ids.insert(ids.end(), std::begin(final_level_set), std::end(final_level_set));
+		}
+		// plus whatever the level's furniture, tenants etc. were created with
+		for (const RenderRequest &request : registry.renderRequests.components)
+		{
+			if (request.used_sprite != SPRITE_ASSET_ID::SPRITE_COUNT)
+			{
+				ids.push_back(sprite_table[(int)request.used_sprite].texture);
+			}
+			else if (request.used_texture != TEXTURE_ASSET_ID::TEXTURE_COUNT)
+			{
+				ids.push_back(request.used_texture);
+			}
+		}
+		break;
 	}
-	gl_has_errors();
+	textures.set_preload(ids);
 }
 
 // TEXTURE, # Rows, # columns, width/sprite, height/sprite
@@ -239,6 +439,31 @@ void RenderSystem::initializeSpriteSheets()
 	sprite_sheets[SPRITE_ASSET_ID::TENANT_4] = {TEXTURE_ASSET_ID::TENANT_4, 6, 6, 64, 64};
 	sprite_sheets[SPRITE_ASSET_ID::PROGRESS_CIRCLE] = {TEXTURE_ASSET_ID::PROGRESS_CIRCLE, 3, 3, 16, 16};
 	sprite_sheets[SPRITE_ASSET_ID::SPIKE] = {TEXTURE_ASSET_ID::SPIKE, 1, 7, 64, 64};
+
+	compileSpriteSheets();
+}
+
+// Works out the texture coordinates of every frame of every sheet up front, draws just read them back
+void RenderSystem::compileSpriteSheets()
+{
+	sprite_table.fill(SpriteSheetEntry());
+	sprite_uvs.clear();
+
+	for (const auto &sheet : sprite_sheets)
+	{
+		const SpriteSheetInfo &info = sheet.second;
+		SpriteSheetEntry &entry = sprite_table[(int)sheet.first];
+		entry.texture = info.texture_id;
+		entry.first_frame = (int)sprite_uvs.size();
+		entry.frame_count = info.rows * info.cols;
+
+		for (int i = 0; i < entry.frame_count; i++)
+		{
+			float u0, v0, u1, v1;
+			getUVCoordinates(sheet.first, i, u0, v0, u1, v1);
+			sprite_uvs.push_back({{u0, v0}, {u1 - u0, v1 - v0}});
+		}
+	}
 }
 
 void RenderSystem::initializeGlEffects()
@@ -389,9 +614,11 @@ RenderSystem::~RenderSystem()
 	gl_has_errors();
 
 	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &m_font_vbo);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteVertexArrays(1, &m_font_vao);
+	glDeleteTextures(1, &font_atlas);
+	glDeleteBuffers(1, &damage_number_vbo);
+	stream_buffer.shutdown();
 
 	for (uint i = 0; i < effect_count; i++)
 	{
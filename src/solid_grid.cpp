@@ -0,0 +1,86 @@
+// internal
+#include "solid_grid.hpp"
+
+SolidGrid solid_grid;
+
+void SolidGrid::insert(Entity entity, const Motion &motion, COLLISION_LAYER layer)
+{
+	if (tiles_of.count(entity))
+	{
+		remove(entity);
+	}
+
+	vec2 half = abs(motion.scale) / 2.f;
+	ivec2 min_tile = world_to_tile(motion.position - half);
+	ivec2 max_tile = world_to_tile(motion.position + half);
+
+	for (int y = min_tile.y; y <= max_tile.y; y++)
+	{
+		for (int x = min_tile.x; x <= max_tile.x; x++)
+		{
+			buckets[tile_key(x, y)].push_back({entity, motion, layer, layer == COLLISION_LAYER::TRIGGER, min_tile});
+		}
+	}
+	tiles_of[entity] = {min_tile, max_tile};
+}
+
+void SolidGrid::remove(Entity entity)
+{
+	auto it = tiles_of.find(entity);
+	if (it == tiles_of.end())
+	{
+		return;
+	}
+
+	ivec2 min_tile = it->second.first;
+	ivec2 max_tile = it->second.second;
+	for (int y = min_tile.y; y <= max_tile.y; y++)
+	{
+		for (int x = min_tile.x; x <= max_tile.x; x++)
+		{
+			erase_from_bucket(tile_key(x, y), entity);
+		}
+	}
+	tiles_of.erase(it);
+}
+
+void SolidGrid::clear()
+{
+	buckets.clear();
+	tiles_of.clear();
+	removed.clear();
+}
+
+void SolidGrid::collect()
+{
+	for (Entity entity : removed)
+	{
+		remove(entity);
+	}
+	removed.clear();
+}
+
+void SolidGrid::erase_from_bucket(uint64_t key, Entity entity)
+{
+	auto it = buckets.find(key);
+	if (it == buckets.end())
+	{
+		return;
+	}
+
+	std::vector<SolidEntry> &bucket = it->second;
+	for (size_t i = 0; i < bucket.size(); i++)
+	{
+		if (bucket[i].entity == entity)
+		{
+			bucket[i] = bucket.back();
+			bucket.pop_back();
+			break;
+		}
+	}
+
+	if (bucket.empty())
+	{
+		buckets.erase(it);
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+// stlib
+#include <unordered_map>
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Static index of the colliders that never move, bucketed by the tiles their bounding box covers
+// Holds the solid objects (walls and furniture) movers are swept against, and the triggers (stickies, eatables,
+// hold interacts and doors) that are only reported as collisions, so neither goes through the pairwise collision loop
+// A copy of each one's motion is kept with its bucket entry and a query never touches the registry
+// Solids are added / removed as the map streams in and out, entries for colliders removed any other way are dropped when a query finds them
+class SolidGrid
+{
+public:
+	struct SolidEntry
+	{
+		Entity entity;
+		Motion motion;
+		COLLISION_LAYER layer;
+		// triggers are reported by for_each_near but don't block movement
+		bool trigger;
+		// first tile it covers, a collider spanning several tiles is only reported from the first one both boxes share
+		ivec2 min_tile;
+	};
+
+	// motion has to be final, the collider is never moved after this
+	void insert(Entity entity, const Motion &motion, COLLISION_LAYER layer);
+	void remove(Entity entity);
+	void clear();
+	bool contains(Entity entity) const { return tiles_of.count(entity) > 0; }
+
+	// Calls fn(const Motion &solid) for the solids (not triggers) bucketed in the tiles overlapped by [box_min, box_max]
+	// Solids covering several tiles can be visited more than once, stops and returns true as soon as fn does
+	template <typename Fn>
+	bool any_of(vec2 box_min, vec2 box_max, Fn fn);
+
+	// Calls fn(const SolidEntry &entry) once for every collider, solid or trigger, bucketed in the tiles overlapped by [box_min, box_max]
+	template <typename Fn>
+	void for_each_near(vec2 box_min, vec2 box_max, Fn fn);
+
+	// Drops the entries for_each_near found removed from the registry
+	void collect();
+
+	// Calls fn(vec2 cell_min, vec2 cell_max, size_t count) for every cell holding solids (debug view of the grid)
+	template <typename Fn>
+	void for_each_cell(Fn fn) const;
+
+	size_t size() const { return tiles_of.size(); }
+
+private:
+	static uint64_t tile_key(int x, int y)
+	{
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+	}
+	void erase_from_bucket(uint64_t key, Entity entity);
+
+	std::unordered_map<uint64_t, std::vector<SolidEntry>> buckets;
+	// tile range (min, max) each collider was bucketed in
+	std::unordered_map<unsigned int, std::pair<ivec2, ivec2>> tiles_of;
+	std::vector<Entity> removed;
+};
+
+extern SolidGrid solid_grid;
+
+template <typename Fn>
+void SolidGrid::for_each_cell(Fn fn) const
+{
+	for (const auto &bucket : buckets)
+	{
+		int x = (int)(uint32_t)(bucket.first >> 32);
+		int y = (int)(uint32_t)bucket.first;
+		fn(tile_min({x, y}), tile_min({x + 1, y + 1}), bucket.second.size());
+	}
+}
+
+template <typename Fn>
+bool SolidGrid::any_of(vec2 box_min, vec2 box_max, Fn fn)
+{
+	ivec2 min_tile = world_to_tile(box_min);
+	ivec2 max_tile = world_to_tile(box_max);
+
+	for (int y = min_tile.y; y <= max_tile.y; y++)
+	{
+		for (int x = min_tile.x; x <= max_tile.x; x++)
+		{
+			auto it = buckets.find(tile_key(x, y));
+			if (it == buckets.end())
+			{
+				continue;
+			}
+
+			std::vector<SolidEntry> &bucket = it->second;
+			for (size_t i = 0; i < bucket.size(); i++)
+			{
+				// collider was removed without going through the grid (level reset, menus)
+				if (!registry.colliders.has(bucket[i].entity))
+				{
+					remove(bucket[i].entity);
+					// bucket may have been erased entirely
+					return any_of(box_min, box_max, fn);
+				}
+
+				if (!bucket[i].trigger && fn(bucket[i].motion))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+template <typename Fn>
+void SolidGrid::for_each_near(vec2 box_min, vec2 box_max, Fn fn)
+{
+	ivec2 min_tile = world_to_tile(box_min);
+	ivec2 max_tile = world_to_tile(box_max);
+
+	for (int y = min_tile.y; y <= max_tile.y; y++)
+	{
+		for (int x = min_tile.x; x <= max_tile.x; x++)
+		{
+			auto it = buckets.find(tile_key(x, y));
+			if (it == buckets.end())
+			{
+				continue;
+			}
+
+			for (const SolidEntry &entry : it->second)
+			{
+				// can't be erased while the bucket is being walked, collect() drops it afterwards
+				if (!registry.colliders.has(entry.entity))
+				{
+					removed.push_back(entry.entity);
+					continue;
+				}
+
+				// both boxes cover every tile from the larger of their min tiles, report the pair from that one only
+				if (x != max(min_tile.x, entry.min_tile.x) || y != max(min_tile.y, entry.min_tile.y))
+				{
+					continue;
+				}
+				fn(entry);
+			}
+		}
+	}
+}
@@ -0,0 +1,392 @@
+// internal
+#include "sound_bank.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// bank layout (little endian):
+//   "SBNK", version, count
+//   count entries of { name[ENTRY_NAME_SIZE], source_size, offset, size, frames, rate, channels }
+//   the ADPCM WAV files the entries point at
+static const char BANK_MAGIC[4] = {'S', 'B', 'N', 'K'};
+static const size_t ENTRY_NAME_SIZE = 32;
+static const size_t HEADER_SIZE = 12;
+static const size_t ENTRY_SIZE = ENTRY_NAME_SIZE + 6 * 4;
+
+// bytes per channel in an ADPCM block, 4 byte header + 1016 samples at 4 bits
+static const int ADPCM_BLOCK_BYTES = 512;
+static const int ADPCM_BLOCK_FRAMES = (ADPCM_BLOCK_BYTES - 4) * 2 + 1;
+
+static const int ima_index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+static const int ima_step_table[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static void put16(std::vector<uint8_t> &out, uint32_t value)
+{
+	out.push_back(value & 0xff);
+	out.push_back((value >> 8) & 0xff);
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t value)
+{
+	put16(out, value & 0xffff);
+	put16(out, value >> 16);
+}
+
+static uint32_t get32(const uint8_t *in)
+{
+	return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static std::string file_name(const std::string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static int64_t file_size(const std::string &path)
+{
+	SDL_RWops *file = SDL_RWFromFile(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return -1;
+	}
+	int64_t size = SDL_RWsize(file);
+	SDL_RWclose(file);
+	return size;
+}
+
+// one IMA ADPCM channel state, encodes a sample into a nibble the same way the decoder will read it back
+struct AdpcmChannel
+{
+	int predictor = 0;
+	int index = 0;
+
+	uint8_t encode(int sample)
+	{
+		int step = ima_step_table[index];
+		int diff = sample - predictor;
+		uint8_t nibble = 0;
+		if (diff < 0)
+		{
+			nibble = 8;
+			diff = -diff;
+		}
+
+		int delta = step >> 3;
+		if (diff >= step)
+		{
+			nibble |= 4;
+			diff -= step;
+			delta += step;
+		}
+		step >>= 1;
+		if (diff >= step)
+		{
+			nibble |= 2;
+			diff -= step;
+			delta += step;
+		}
+		step >>= 1;
+		if (diff >= step)
+		{
+			nibble |= 1;
+			delta += step;
+		}
+
+		predictor += (nibble & 8) ? -delta : delta;
+		predictor = std::min(std::max(predictor, -32768), 32767);
+		index = std::min(std::max(index + ima_index_table[nibble], 0), 88);
+		return nibble;
+	}
+};
+
+// Encodes interleaved 16 bit samples as an IMA ADPCM WAV file (format 0x11), the last block is padded with silence
+// and the fact chunk holds the real length
+static void encode_adpcm_wav(const int16_t *samples, uint32_t frames, int channels, int rate, std::vector<uint8_t> &out)
+{
+	uint32_t block_align = ADPCM_BLOCK_BYTES * channels;
+	uint32_t blocks = (frames + ADPCM_BLOCK_FRAMES - 1) / ADPCM_BLOCK_FRAMES;
+	uint32_t data_size = blocks * block_align;
+
+	out.clear();
+	out.insert(out.end(), {'R', 'I', 'F', 'F'});
+	put32(out, 4 + (8 + 20) + (8 + 4) + (8 + data_size));
+	out.insert(out.end(), {'W', 'A', 'V', 'E'});
+
+	out.insert(out.end(), {'f', 'm', 't', ' '});
+	put32(out, 20);
+	put16(out, 0x11);
+	put16(out, channels);
+	put32(out, rate);
+	put32(out, (uint32_t)((uint64_t)rate * block_align / ADPCM_BLOCK_FRAMES));
+	put16(out, block_align);
+	put16(out, 4);
+	put16(out, 2);
+	put16(out, ADPCM_BLOCK_FRAMES);
+
+	out.insert(out.end(), {'f', 'a', 'c', 't'});
+	put32(out, 4);
+	put32(out, frames);
+
+	out.insert(out.end(), {'d', 'a', 't', 'a'});
+	put32(out, data_size);
+
+	auto sample_at = [&](uint32_t frame, int channel) -> int
+	{
+		return frame < frames ? samples[frame * channels + channel] : 0;
+	};
+
+	AdpcmChannel state[2];
+	for (uint32_t block = 0; block < blocks; block++)
+	{
+		uint32_t first = block * ADPCM_BLOCK_FRAMES;
+
+		// each channel's block starts with its first sample uncompressed
+		for (int c = 0; c < channels; c++)
+		{
+			state[c].predictor = sample_at(first, c);
+			put16(out, (uint16_t)(int16_t)state[c].predictor);
+			out.push_back((uint8_t)state[c].index);
+			out.push_back(0);
+		}
+
+		// then runs of 8 samples (4 bytes) per channel, interleaved channel by channel
+		for (uint32_t frame = first + 1; frame < first + ADPCM_BLOCK_FRAMES; frame += 8)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				for (int i = 0; i < 8; i += 2)
+				{
+					uint8_t low = state[c].encode(sample_at(frame + i, c));
+					uint8_t high = state[c].encode(sample_at(frame + i + 1, c));
+					out.push_back(low | (high << 4));
+				}
+			}
+		}
+	}
+}
+
+bool SoundBank::open(const std::string &path)
+{
+	if (load(path) && !stale())
+	{
+		return true;
+	}
+
+	fprintf(stderr, "Baking sound bank %s\n", path.c_str());
+	if (!bake(path))
+	{
+		fprintf(stderr, "Failed to bake sound bank %s\n", path.c_str());
+		return false;
+	}
+	return load(path);
+}
+
+bool SoundBank::load(const std::string &path)
+{
+	data.clear();
+	SDL_RWops *file = SDL_RWFromFile(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	int64_t size = SDL_RWsize(file);
+	if (size > 0)
+	{
+		data.resize((size_t)size);
+		if (SDL_RWread(file, data.data(), 1, data.size()) != data.size())
+		{
+			data.clear();
+		}
+	}
+	SDL_RWclose(file);
+
+	if (data.size() < HEADER_SIZE + ENTRY_SIZE * sound_count ||
+		memcmp(data.data(), BANK_MAGIC, sizeof(BANK_MAGIC)) != 0 ||
+		get32(&data[4]) != VERSION ||
+		get32(&data[8]) != (uint32_t)sound_count)
+	{
+		data.clear();
+		return false;
+	}
+
+	for (int i = 0; i < sound_count; i++)
+	{
+		const uint8_t *in = &data[HEADER_SIZE + i * ENTRY_SIZE];
+		std::string name((const char *)in, strnlen((const char *)in, ENTRY_NAME_SIZE));
+		Entry &entry = entries[i];
+		entry.source_size = get32(in + ENTRY_NAME_SIZE);
+		entry.offset = get32(in + ENTRY_NAME_SIZE + 4);
+		entry.size = get32(in + ENTRY_NAME_SIZE + 8);
+		entry.frames = get32(in + ENTRY_NAME_SIZE + 12);
+		entry.rate = get32(in + ENTRY_NAME_SIZE + 16);
+		entry.channels = get32(in + ENTRY_NAME_SIZE + 20);
+
+		// the sound list changed or the file is cut short
+		if (name != file_name(sound_paths[i]) || (uint64_t)entry.offset + entry.size > data.size())
+		{
+			data.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SoundBank::stale() const
+{
+	for (int i = 0; i < sound_count; i++)
+	{
+		// a missing source is fine (shipping only the bank), a changed one needs a rebake
+		int64_t size = file_size(sound_paths[i]);
+		if (size >= 0 && (uint32_t)size != entries[i].source_size)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SoundBank::bake(const std::string &path) const
+{
+	std::vector<uint8_t> index;
+	std::vector<uint8_t> blobs;
+	std::vector<uint8_t> wav;
+	size_t blobs_offset = HEADER_SIZE + ENTRY_SIZE * sound_count;
+
+	index.insert(index.end(), BANK_MAGIC, BANK_MAGIC + sizeof(BANK_MAGIC));
+	put32(index, VERSION);
+	put32(index, sound_count);
+
+	for (int i = 0; i < sound_count; i++)
+	{
+		SDL_AudioSpec spec;
+		Uint8 *buffer = nullptr;
+		Uint32 length = 0;
+		if (SDL_LoadWAV(sound_paths[i].c_str(), &spec, &buffer, &length) == nullptr)
+		{
+			fprintf(stderr, "Failed to load %s: %s\n", sound_paths[i].c_str(), SDL_GetError());
+			return false;
+		}
+
+		// ADPCM is encoded from 16 bit samples, keep the source's rate and channels (the mixer converts when decoding)
+		int channels = std::min((int)spec.channels, 2);
+		SDL_AudioCVT cvt;
+		if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_S16SYS, channels, spec.freq) < 0)
+		{
+			SDL_FreeWAV(buffer);
+			return false;
+		}
+		std::vector<uint8_t> converted(std::max((size_t)length * cvt.len_mult, (size_t)length));
+		memcpy(converted.data(), buffer, length);
+		SDL_FreeWAV(buffer);
+		cvt.buf = converted.data();
+		cvt.len = (int)length;
+		if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+		{
+			return false;
+		}
+		uint32_t converted_bytes = cvt.needed ? (uint32_t)cvt.len_cvt : length;
+		uint32_t frames = converted_bytes / (2 * channels);
+
+		encode_adpcm_wav((const int16_t *)converted.data(), frames, channels, spec.freq, wav);
+
+		char name[ENTRY_NAME_SIZE] = {};
+		std::string source_name = file_name(sound_paths[i]);
+		strncpy(name, source_name.c_str(), ENTRY_NAME_SIZE - 1);
+		index.insert(index.end(), name, name + ENTRY_NAME_SIZE);
+		put32(index, (uint32_t)std::max(file_size(sound_paths[i]), (int64_t)0));
+		put32(index, (uint32_t)(blobs_offset + blobs.size()));
+		put32(index, (uint32_t)wav.size());
+		put32(index, frames);
+		put32(index, spec.freq);
+		put32(index, channels);
+		blobs.insert(blobs.end(), wav.begin(), wav.end());
+	}
+
+	SDL_RWops *file = SDL_RWFromFile(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	bool written = SDL_RWwrite(file, index.data(), 1, index.size()) == index.size() &&
+				   SDL_RWwrite(file, blobs.data(), 1, blobs.size()) == blobs.size();
+	SDL_RWclose(file);
+	return written;
+}
+
+Mix_Chunk *SoundBank::acquire(SOUND_ASSET_ID id, uint64_t now)
+{
+	int index = (int)id;
+	if (data.empty() || index < 0 || index >= sound_count)
+	{
+		return nullptr;
+	}
+
+	last_used[index] = now;
+	if (chunks[index] == nullptr)
+	{
+		const Entry &entry = entries[index];
+		SDL_RWops *blob = SDL_RWFromConstMem(&data[entry.offset], (int)entry.size);
+		chunks[index] = Mix_LoadWAV_RW(blob, 1);
+		if (chunks[index] == nullptr)
+		{
+			fprintf(stderr, "Failed to decode %s: %s\n", sound_paths[index].c_str(), Mix_GetError());
+			return nullptr;
+		}
+		decode_count += 1;
+		resident_total += chunks[index]->alen;
+		resident_peak = std::max(resident_peak, resident_total);
+	}
+	return chunks[index];
+}
+
+void SoundBank::free_chunk(int index)
+{
+	resident_total -= chunks[index]->alen;
+	Mix_FreeChunk(chunks[index]);
+	chunks[index] = nullptr;
+}
+
+void SoundBank::release_all()
+{
+	for (int i = 0; i < sound_count; i++)
+	{
+		if (chunks[i] != nullptr)
+		{
+			free_chunk(i);
+		}
+	}
+}
+
+size_t SoundBank::decoded_total_bytes() const
+{
+	int rate = 0;
+	Uint16 format = 0;
+	int channels = 0;
+	if (data.empty() || Mix_QuerySpec(&rate, &format, &channels) == 0)
+	{
+		return 0;
+	}
+
+	size_t total = 0;
+	for (const Entry &entry : entries)
+	{
+		uint64_t device_frames = (uint64_t)entry.frames * rate / std::max(entry.rate, 1u);
+		total += (size_t)(device_frames * channels * (SDL_AUDIO_BITSIZE(format) / 8));
+	}
+	return total;
+}
+
+void SoundBank::report(const char *when) const
+{
+	fprintf(stderr, "Sound bank (%s): %zu KB compressed, %zu KB decoded now (peak %zu KB, %u decodes), %zu KB if every sound were decoded\n",
+			when, compressed_bytes() / 1024, resident_bytes() / 1024, peak_resident_bytes() / 1024, decode_count,
+			decoded_total_bytes() / 1024);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// stlib
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SDL_mixer.h>
+
+#include "common.hpp"
+#include "components.hpp"
+
+// Every sound effect packed into one file, stored as IMA ADPCM (4 bits a sample) and decoded into a Mix_Chunk only when it is needed
+// The bank is baked from the WAVs in data/audio the first time the game runs (and again whenever one of them changes),
+// after that only the bank is read at startup and nothing is decoded before the first frame
+// Decoded chunks are freed least recently used first once they go over the memory budget
+// Not thread safe, after open() it belongs to the audio thread, and chunks have to be released before the mixer closes
+class SoundBank
+{
+public:
+	static const uint32_t VERSION = 1;
+
+	// Reads the bank at path into memory, baking it first if it is missing or out of date
+	bool open(const std::string &path);
+
+	// The decoded chunk for id, decoding it now if it isn't resident; now orders chunks for eviction
+	Mix_Chunk *acquire(SOUND_ASSET_ID id, uint64_t now);
+	bool resident(SOUND_ASSET_ID id) const { return chunks[(int)id] != nullptr; }
+
+	// Frees least recently used chunks until at most budget bytes are resident, chunks for which in_use(id) is true stay
+	template <typename Fn>
+	void evict(size_t budget, Fn in_use);
+	void release_all();
+
+	// Resident is decoded sample memory, decoded_total is what decoding every sound up front would take
+	size_t compressed_bytes() const { return data.size(); }
+	size_t resident_bytes() const { return resident_total; }
+	size_t peak_resident_bytes() const { return resident_peak; }
+	size_t decoded_total_bytes() const;
+	void report(const char *when) const;
+
+	const std::array<std::string, sound_count> sound_paths = {
+		audio_path("click.wav"),
+		audio_path("eat_sound.wav"),
+		audio_path("damage.wav"),
+		audio_path("enemy_damage.wav"),
+		audio_path("level_up_select.wav"),
+		audio_path("level_up.wav"),
+		audio_path("door.wav"),
+		audio_path("summon.wav"),
+		audio_path("exp.wav")};
+
+private:
+	struct Entry
+	{
+		// size of the WAV it was baked from, a different size means the bank is stale
+		uint32_t source_size;
+		// where its ADPCM WAV lives in the bank
+		uint32_t offset;
+		uint32_t size;
+		uint32_t frames;
+		uint32_t rate;
+		uint32_t channels;
+	};
+
+	bool load(const std::string &path);
+	bool stale() const;
+	bool bake(const std::string &path) const;
+	void free_chunk(int index);
+
+	std::vector<uint8_t> data;
+	Entry entries[sound_count] = {};
+	Mix_Chunk *chunks[sound_count] = {};
+	uint64_t last_used[sound_count] = {};
+	size_t resident_total = 0;
+	size_t resident_peak = 0;
+	uint32_t decode_count = 0;
+};
+
+template <typename Fn>
+void SoundBank::evict(size_t budget, Fn in_use)
+{
+	while (resident_total > budget)
+	{
+		int oldest = -1;
+		for (int i = 0; i < sound_count; i++)
+		{
+			if (chunks[i] != nullptr && !in_use((SOUND_ASSET_ID)i) && (oldest < 0 || last_used[i] < last_used[oldest]))
+			{
+				oldest = i;
+			}
+		}
+		if (oldest < 0)
+		{
+			// everything resident is playing, try again once some of it stops
+			return;
+		}
+		free_chunk(oldest);
+	}
+}
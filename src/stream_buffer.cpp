@@ -0,0 +1,148 @@
+// internal
+#include "stream_buffer.hpp"
+
+#include <cassert>
+#include <cstring>
+
+GlStreamBackend::~GlStreamBackend()
+{
+	if (buffer != 0)
+	{
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+void GlStreamBackend::allocate(size_t size)
+{
+	if (buffer == 0)
+	{
+		glGenBuffers(1, &buffer);
+	}
+	// copy write target so the array buffer binding the renderer tracks isn't disturbed
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	gl_has_errors();
+}
+
+void GlStreamBackend::write(size_t offset, const void *data, size_t size)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	// unsynchronized, the ring guarantees the GPU isn't reading this range
+	void *dst = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+								 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (dst != nullptr)
+	{
+		memcpy(dst, data, size);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	gl_has_errors();
+}
+
+uintptr_t GlStreamBackend::insert_fence()
+{
+	return (uintptr_t)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GlStreamBackend::wait_fence(uintptr_t fence)
+{
+	GLsync sync = (GLsync)fence;
+	// flush on the first try so the fence is guaranteed to signal
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum result = glClientWaitSync(sync, flags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+		{
+			break;
+		}
+		flags = 0;
+	}
+	glDeleteSync(sync);
+}
+
+void GlStreamBackend::delete_fence(uintptr_t fence)
+{
+	glDeleteSync((GLsync)fence);
+}
+
+void StreamBuffer::init(StreamBackend *backend_arg, size_t segment_size_arg)
+{
+	backend = backend_arg;
+	segment_size = segment_size_arg;
+	segment = 0;
+	head = 0;
+	backend->allocate(segment_size * SEGMENT_COUNT);
+}
+
+void StreamBuffer::shutdown()
+{
+	for (uintptr_t &fence : fences)
+	{
+		if (fence != 0)
+		{
+			backend->delete_fence(fence);
+			fence = 0;
+		}
+	}
+	backend = nullptr;
+}
+
+void StreamBuffer::begin_frame()
+{
+	segment = (segment + 1) % SEGMENT_COUNT;
+	head = 0;
+
+	if (fences[segment] != 0)
+	{
+		backend->wait_fence(fences[segment]);
+		fences[segment] = 0;
+	}
+}
+
+void StreamBuffer::end_frame()
+{
+	assert(fences[segment] == 0);
+	fences[segment] = backend->insert_fence();
+}
+
+size_t StreamBuffer::write(const void *data, size_t size, size_t alignment)
+{
+	assert(alignment > 0);
+	size_t start = ((head + alignment - 1) / alignment) * alignment;
+
+	if (start + size > segment_size)
+	{
+		orphan(size + alignment);
+		start = 0;
+	}
+
+	size_t offset = segment * segment_size + start;
+	// holds as long as the segment size is a multiple of the alignment (both powers of two here)
+	assert(offset % alignment == 0);
+	backend->write(offset, data, size);
+	head = start + size;
+	return offset;
+}
+
+// Swaps in fresh storage, earlier draws keep reading the old storage so none of the fences matter anymore
+void StreamBuffer::orphan(size_t min_segment_size)
+{
+	for (uintptr_t &fence : fences)
+	{
+		if (fence != 0)
+		{
+			backend->delete_fence(fence);
+			fence = 0;
+		}
+	}
+
+	while (segment_size < min_segment_size)
+	{
+		segment_size *= 2;
+	}
+	backend->allocate(segment_size * SEGMENT_COUNT);
+	orphans++;
+	head = 0;
+}
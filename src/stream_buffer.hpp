@@ -0,0 +1,81 @@
+#pragma once
+
+// stlib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+
+// GL calls the stream buffer makes, kept behind an interface so the ring logic runs against a stub without a context
+class StreamBackend
+{
+public:
+	virtual ~StreamBackend() {}
+
+	// (re)allocates storage of size bytes, the old storage stays alive until the GPU is done with it
+	virtual void allocate(size_t size) = 0;
+	virtual void write(size_t offset, const void *data, size_t size) = 0;
+	virtual uintptr_t insert_fence() = 0;
+	// blocks until the GPU has passed the fence, then deletes it
+	virtual void wait_fence(uintptr_t fence) = 0;
+	virtual void delete_fence(uintptr_t fence) = 0;
+	virtual GLuint handle() const = 0;
+};
+
+// Writes straight into buffer memory the GPU isn't reading, synchronized with fences instead of the driver
+class GlStreamBackend : public StreamBackend
+{
+public:
+	~GlStreamBackend();
+
+	void allocate(size_t size) override;
+	void write(size_t offset, const void *data, size_t size) override;
+	uintptr_t insert_fence() override;
+	void wait_fence(uintptr_t fence) override;
+	void delete_fence(uintptr_t fence) override;
+	GLuint handle() const override { return buffer; }
+
+private:
+	GLuint buffer = 0;
+};
+
+// Buffer for data that is rebuilt every frame (text quads, particle instances)
+// Split in SEGMENT_COUNT segments used round robin, one per frame, so the CPU fills one while the GPU reads the others
+// A segment is only reused once the fence placed at the end of its frame has passed
+// If a frame needs more than a segment holds the buffer is orphaned and regrown rather than stalling
+class StreamBuffer
+{
+public:
+	static const int SEGMENT_COUNT = 3;
+
+	// segment_size should be a power of two so every segment starts aligned
+	void init(StreamBackend *backend, size_t segment_size);
+	void shutdown();
+
+	// Moves to the next segment, waiting for the GPU to finish with it if it hasn't yet
+	void begin_frame();
+	// Fences the current segment, call after the last draw reading from this frame's data
+	void end_frame();
+
+	// Copies size bytes into this frame's segment, returns the byte offset of the copy in the buffer (a multiple of alignment)
+	// Issue the draws reading a range before the next write, an overflow swaps the storage out from under unused ranges
+	size_t write(const void *data, size_t size, size_t alignment);
+
+	GLuint handle() const { return backend->handle(); }
+	size_t segment_capacity() const { return segment_size; }
+	int current_segment() const { return segment; }
+	// times the buffer had to be orphaned because a frame overflowed its segment
+	int orphan_count() const { return orphans; }
+
+private:
+	void orphan(size_t min_segment_size);
+
+	StreamBackend *backend = nullptr;
+	size_t segment_size = 0;
+	int segment = 0;
+	size_t head = 0;
+	// fence for each segment, 0 if the GPU isn't using it
+	uintptr_t fences[SEGMENT_COUNT] = {};
+	int orphans = 0;
+};
@@ -0,0 +1,180 @@
+// internal
+#include "texture_cache.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdio>
+
+size_t GlTextureUploader::upload(GLuint texture, const std::string &path)
+{
+	ivec2 dimensions;
+	stbi_uc *data = stbi_load(path.c_str(), &dimensions.x, &dimensions.y, NULL, 4);
+	if (data == NULL)
+	{
+		fprintf(stderr, "Could not load the file %s.\n", path.c_str());
+		return 0;
+	}
+
+	GLint previous = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, previous);
+	gl_has_errors();
+	stbi_image_free(data);
+
+	return (size_t)dimensions.x * dimensions.y * 4;
+}
+
+void GlTextureUploader::release(GLuint texture)
+{
+	// respecifying as 0x0 frees the storage but keeps the name (sprite sheets and draw calls hold on to it)
+	GLint previous = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, previous);
+	gl_has_errors();
+}
+
+void TextureCache::init(TextureUploader *uploader_arg, const GLuint *names_arg, const std::string *paths_arg, size_t budget_arg)
+{
+	uploader = uploader_arg;
+	names = names_arg;
+	paths = paths_arg;
+	budget = budget_arg;
+	slots.fill(Slot());
+	preload_queue.clear();
+	resident_total = 0;
+	frame = 0;
+	stats = Stats();
+}
+
+GLuint TextureCache::use(TEXTURE_ASSET_ID id)
+{
+	int index = (int)id;
+	if (index < 0 || index >= texture_count)
+	{
+		// sprite without a sheet, drawn with no texture like before
+		return 0;
+	}
+	Slot &slot = slots[index];
+	if (!slot.resident)
+	{
+		// not preloaded, this frame pays for the upload
+		load(index);
+	}
+	slot.last_used = frame;
+	return names[index];
+}
+
+void TextureCache::set_preload(const std::vector<TEXTURE_ASSET_ID> &ids)
+{
+	for (Slot &slot : slots)
+	{
+		slot.pinned = false;
+	}
+	preload_queue.clear();
+
+	for (TEXTURE_ASSET_ID id : ids)
+	{
+		if ((int)id < 0 || (int)id >= texture_count)
+		{
+			continue;
+		}
+		Slot &slot = slots[(int)id];
+		if (slot.pinned)
+		{
+			continue;
+		}
+		slot.pinned = true;
+		if (!slot.resident)
+		{
+			preload_queue.push_back(id);
+		}
+	}
+	// uploaded from the back, keep the order the set was given in
+	std::reverse(preload_queue.begin(), preload_queue.end());
+}
+
+void TextureCache::end_frame()
+{
+	for (int i = 0; i < PRELOADS_PER_FRAME && !preload_queue.empty(); i++)
+	{
+		int index = (int)preload_queue.back();
+		preload_queue.pop_back();
+		if (!slots[index].resident)
+		{
+			load(index);
+			stats.preloads += 1;
+			// counts as used now so it isn't cold by the time it is needed
+			slots[index].last_used = frame;
+		}
+	}
+
+	while (resident_total > budget)
+	{
+		int oldest = -1;
+		for (int i = 0; i < texture_count; i++)
+		{
+			const Slot &slot = slots[i];
+			if (slot.resident && !slot.pinned && frame - slot.last_used >= COLD_FRAMES &&
+				(oldest < 0 || slot.last_used < slots[oldest].last_used))
+			{
+				oldest = i;
+			}
+		}
+		if (oldest < 0)
+		{
+			// everything resident is in use, going over budget beats reloading every frame
+			break;
+		}
+		evict(oldest);
+	}
+
+	frame += 1;
+}
+
+void TextureCache::release_all()
+{
+	for (int i = 0; i < texture_count; i++)
+	{
+		if (slots[i].resident)
+		{
+			evict(i);
+		}
+	}
+	preload_queue.clear();
+}
+
+int TextureCache::resident_count() const
+{
+	int count = 0;
+	for (const Slot &slot : slots)
+	{
+		count += slot.resident ? 1 : 0;
+	}
+	return count;
+}
+
+void TextureCache::load(int index)
+{
+	Slot &slot = slots[index];
+	slot.bytes = uploader->upload(names[index], paths[index]);
+	// marked resident even if it failed, a missing file is reported once instead of every frame
+	slot.resident = true;
+	resident_total += slot.bytes;
+	stats.loads += 1;
+}
+
+void TextureCache::evict(int index)
+{
+	Slot &slot = slots[index];
+	uploader->release(names[index]);
+	resident_total -= slot.bytes;
+	slot.bytes = 0;
+	slot.resident = false;
+	stats.evictions += 1;
+}
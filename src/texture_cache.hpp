@@ -0,0 +1,93 @@
+#pragma once
+
+// stlib
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "components.hpp"
+
+// GL calls the texture cache makes, kept behind an interface so the residency policy runs against a fake without a context
+class TextureUploader
+{
+public:
+	virtual ~TextureUploader() {}
+
+	// Gives texture the image at path, returns the bytes it takes on the GPU (0 if it couldn't be loaded)
+	virtual size_t upload(GLuint texture, const std::string &path) = 0;
+	// Drops texture's storage, the name stays valid for a later upload
+	virtual void release(GLuint texture) = 0;
+};
+
+// Decodes with stb_image and uploads as RGBA, leaves the GL_TEXTURE_2D binding as it found it
+class GlTextureUploader : public TextureUploader
+{
+public:
+	size_t upload(GLuint texture, const std::string &path) override;
+	void release(GLuint texture) override;
+};
+
+// Keeps textures resident only while they are used
+// Every TEXTURE_ASSET_ID has a GL name from the start, its storage is uploaded the first time use() asks for it
+// Textures unused for COLD_FRAMES frames are released, least recently used first, whenever the total goes over the budget
+// The preload set (the textures the current game state and level will need) is uploaded a few per frame ahead of use
+// and is never evicted while it stands
+class TextureCache
+{
+public:
+	static const uint64_t COLD_FRAMES = 120;
+	static const int PRELOADS_PER_FRAME = 1;
+
+	// names and paths have texture_count entries, both must outlive the cache
+	void init(TextureUploader *uploader, const GLuint *names, const std::string *paths, size_t budget);
+
+	// GL name of id with its storage resident, marks it used this frame (0 for TEXTURE_COUNT)
+	GLuint use(TEXTURE_ASSET_ID id);
+
+	// Replaces the preload set, textures in it that aren't resident are queued for upload
+	void set_preload(const std::vector<TEXTURE_ASSET_ID> &ids);
+
+	// Uploads queued preloads and evicts cold textures over budget, call once per frame after drawing
+	void end_frame();
+	void release_all();
+
+	void set_budget(size_t bytes) { budget = bytes; }
+	size_t get_budget() const { return budget; }
+	bool resident(TEXTURE_ASSET_ID id) const { return slots[(int)id].resident; }
+	size_t resident_bytes() const { return resident_total; }
+	int resident_count() const;
+
+	struct Stats
+	{
+		int loads = 0;
+		int evictions = 0;
+		int preloads = 0;
+	};
+	const Stats &get_stats() const { return stats; }
+
+private:
+	struct Slot
+	{
+		size_t bytes = 0;
+		uint64_t last_used = 0;
+		bool resident = false;
+		bool pinned = false;
+	};
+
+	void load(int index);
+	void evict(int index);
+
+	TextureUploader *uploader = nullptr;
+	const GLuint *names = nullptr;
+	const std::string *paths = nullptr;
+	size_t budget = 0;
+
+	std::array<Slot, texture_count> slots;
+	std::vector<TEXTURE_ASSET_ID> preload_queue;
+	size_t resident_total = 0;
+	uint64_t frame = 0;
+	Stats stats;
+};
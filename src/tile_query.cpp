@@ -0,0 +1,147 @@
+// internal
+#include "tile_query.hpp"
+
+// stlib
+#include <algorithm>
+#include <climits>
+
+TileQuery tile_query;
+
+TileQuery::TileQuery()
+{
+	rng = std::default_random_engine(std::random_device()());
+}
+
+void TileQuery::build(const std::vector<std::vector<int>> &map)
+{
+	height = (int)map.size();
+	width = height > 0 ? (int)map[0].size() : 0;
+
+	cells.resize(width * height);
+	spawnable.clear();
+	for (int row = 0; row < height; row++)
+	{
+		for (int column = 0; column < width; column++)
+		{
+			int value = map[row][column];
+			cells[row * width + column] = value;
+			// floor and the floor decorations, except slime patches (7) which the old spawn list skipped
+			if (value == 1 || (value >= 3 && value <= 8 && value != 7))
+			{
+				spawnable.push_back({column, row});
+			}
+		}
+	}
+
+	// no tile can be further than the map diagonal from the focus tile
+	int bucket_count = (int)ceil(sqrt((float)(width * width + height * height))) + 1;
+	by_distance.resize(spawnable.size());
+	bucket_start.assign(bucket_count + 1, 0);
+	bucket_fill.assign(bucket_count, 0);
+
+	visited_bits.assign((width * height + 63) / 64, 0);
+	queue.resize(width * height);
+
+	// force the buckets to be rebuilt for the new level
+	focus_tile = {INT_MIN, INT_MIN};
+	set_focus(focus_pos);
+}
+
+void TileQuery::set_focus(vec2 pos)
+{
+	focus_pos = pos;
+	ivec2 tile = world_to_tile(pos);
+	if (tile == focus_tile)
+	{
+		return;
+	}
+	focus_tile = tile;
+
+	// counting sort of the spawnable tiles into their distance buckets
+	std::fill(bucket_start.begin(), bucket_start.end(), 0);
+	for (ivec2 spawn_tile : spawnable)
+	{
+		bucket_start[bucket_of(spawn_tile) + 1]++;
+	}
+	for (size_t i = 1; i < bucket_start.size(); i++)
+	{
+		bucket_start[i] += bucket_start[i - 1];
+	}
+	std::copy(bucket_start.begin(), bucket_start.end() - 1, bucket_fill.begin());
+	for (ivec2 spawn_tile : spawnable)
+	{
+		by_distance[bucket_fill[bucket_of(spawn_tile)]++] = spawn_tile;
+	}
+}
+
+bool TileQuery::random_tile_outside(float radius, vec2 &out_pos)
+{
+	return random_from(lower_index(radius), upper_index(radius), [&](vec2 pos)
+					   { return distance(pos, focus_pos) >= radius; }, out_pos);
+}
+
+bool TileQuery::random_tile_outside_view(vec2 half_size, vec2 &out_pos)
+{
+	return random_from(lower_index(min(half_size.x, half_size.y)), upper_index(length(half_size)), [&](vec2 pos)
+					   { return abs(pos.x - focus_pos.x) > half_size.x || abs(pos.y - focus_pos.y) > half_size.y; }, out_pos);
+}
+
+int TileQuery::bucket_of(ivec2 tile) const
+{
+	vec2 offset = vec2(tile - focus_tile);
+	return min((int)length(offset), (int)bucket_fill.size() - 1);
+}
+
+// the focus position is anywhere in its tile, up to ~0.71 tiles from the centre the buckets are measured from,
+// so both bounds keep two buckets of margin
+size_t TileQuery::lower_index(float dist) const
+{
+	if (bucket_start.empty())
+	{
+		return 0;
+	}
+	int bucket = (int)floor(dist / TILE_SIZE) - 2;
+	bucket = max(0, min(bucket, (int)bucket_start.size() - 1));
+	return bucket_start[bucket];
+}
+
+size_t TileQuery::upper_index(float dist) const
+{
+	if (bucket_start.empty())
+	{
+		return 0;
+	}
+	int bucket = (int)floor(dist / TILE_SIZE) + 2;
+	bucket = max(0, min(bucket, (int)bucket_start.size() - 1));
+	return bucket_start[bucket];
+}
+
+template <typename Fits>
+bool TileQuery::random_from(size_t first, size_t fallback, Fits fits, vec2 &out_pos)
+{
+	const int TRIES = 8;
+	size_t end = by_distance.size();
+	if (first < end)
+	{
+		// most of these are far enough, only the few in the boundary buckets need the exact check
+		for (int i = 0; i < TRIES; i++)
+		{
+			size_t index = first + min((size_t)(uniform_dist(rng) * (end - first)), end - first - 1);
+			vec2 pos = tile_centre(by_distance[index]);
+			if (fits(pos))
+			{
+				out_pos = pos;
+				return true;
+			}
+		}
+	}
+
+	// unlucky, everything from fallback on is certainly far enough
+	if (fallback >= end)
+	{
+		return false;
+	}
+	size_t index = fallback + min((size_t)(uniform_dist(rng) * (end - fallback)), end - fallback - 1);
+	out_pos = tile_centre(by_distance[index]);
+	return true;
+}
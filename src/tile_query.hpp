@@ -0,0 +1,130 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "common.hpp"
+
+// Answers placement questions about the tiles of the current level (where to spawn something, nearest tile of a kind)
+// build() copies the level when it is loaded, all the storage a query needs is sized there so queries never allocate
+// Spawnable tiles are kept sorted into buckets by their distance from the focus tile (the player's), re-sorted only when the focus changes tile
+// Tiles are (column, row), the same way the map is indexed with map[row][column]
+class TileQuery
+{
+public:
+	TileQuery();
+
+	void build(const std::vector<std::vector<int>> &map);
+	// Re-buckets the spawnable tiles around the tile containing pos
+	void set_focus(vec2 pos);
+
+	// Random spawnable tile whose centre is at least radius away from the focus position
+	// false if no tile is that far away
+	bool random_tile_outside(float radius, vec2 &out_pos);
+	// Random spawnable tile outside the rectangle of half size half_size centred on the focus position
+	bool random_tile_outside_view(vec2 half_size, vec2 &out_pos);
+
+	// Calls fn(ivec2 tile) for the spawnable tiles between inner and outer (in pixels) from the focus position
+	template <typename Fn>
+	void for_each_in_ring(float inner, float outer, Fn fn) const;
+
+	// Breadth first search over the map (8 neighbours) from start, returns the closest tile for which fn(ivec2 tile, int value) is true
+	template <typename Fn>
+	bool nearest_tile(ivec2 start, Fn fn, ivec2 &out_tile);
+
+	int value(ivec2 tile) const { return cells[tile.y * width + tile.x]; }
+	bool in_bounds(ivec2 tile) const { return tile.x >= 0 && tile.y >= 0 && tile.x < width && tile.y < height; }
+
+private:
+	// distance of tiles in bucket d from the focus tile centre is in [d, d + 1) tiles
+	int bucket_of(ivec2 tile) const;
+	// indices into by_distance: every tile before lower_index(dist) is closer than dist to the focus position,
+	// every tile from upper_index(dist) on is at least dist away
+	size_t lower_index(float dist) const;
+	size_t upper_index(float dist) const;
+	// picks random tiles from by_distance[first, end) until fits(centre) (a few tries), then falls back to [fallback, end)
+	template <typename Fits>
+	bool random_from(size_t first, size_t fallback, Fits fits, vec2 &out_pos);
+
+	bool visited(int index) const { return (visited_bits[index >> 6] >> (index & 63)) & 1; }
+	void visit(int index) { visited_bits[index >> 6] |= (uint64_t)1 << (index & 63); }
+
+	int width = 0;
+	int height = 0;
+	std::vector<int> cells;
+	std::vector<ivec2> spawnable;
+
+	ivec2 focus_tile = {-1, -1};
+	vec2 focus_pos = {0, 0};
+	// spawnable tiles sorted by bucket, bucket d is by_distance[bucket_start[d], bucket_start[d + 1])
+	std::vector<ivec2> by_distance;
+	std::vector<uint32_t> bucket_start;
+	// next free slot of each bucket while sorting
+	std::vector<uint32_t> bucket_fill;
+
+	std::default_random_engine rng;
+	std::uniform_real_distribution<float> uniform_dist; // number between 0..1
+
+	// search state for nearest_tile, sized by build()
+	std::vector<uint64_t> visited_bits;
+	std::vector<ivec2> queue;
+};
+
+extern TileQuery tile_query;
+
+template <typename Fn>
+void TileQuery::for_each_in_ring(float inner, float outer, Fn fn) const
+{
+	size_t end = upper_index(outer);
+	for (size_t i = lower_index(inner); i < end; i++)
+	{
+		float dist = distance(tile_centre(by_distance[i]), focus_pos);
+		if (dist >= inner && dist < outer)
+		{
+			fn(by_distance[i]);
+		}
+	}
+}
+
+template <typename Fn>
+bool TileQuery::nearest_tile(ivec2 start, Fn fn, ivec2 &out_tile)
+{
+	if (!in_bounds(start))
+	{
+		return false;
+	}
+
+	std::fill(visited_bits.begin(), visited_bits.end(), 0);
+	size_t head = 0;
+	size_t tail = 0;
+	queue[tail++] = start;
+	visit(start.y * width + start.x);
+
+	while (head < tail)
+	{
+		ivec2 tile = queue[head++];
+		if (fn(tile, value(tile)))
+		{
+			out_tile = tile;
+			return true;
+		}
+
+		for (int i = -1; i <= 1; i++)
+		{
+			for (int j = -1; j <= 1; j++)
+			{
+				ivec2 next = {tile.x + i, tile.y + j};
+				if ((i == 0 && j == 0) || !in_bounds(next) || visited(next.y * width + next.x))
+				{
+					continue;
+				}
+				// every tile is queued at most once, so the queue never holds more than the map
+				visit(next.y * width + next.x);
+				queue[tail++] = next;
+			}
+		}
+	}
+	return false;
+}
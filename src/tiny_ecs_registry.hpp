@@ -15,7 +15,8 @@ public:
 	ComponentContainer<BlockedTimer> blockedTimers;
 	ComponentContainer<AttackTimer> attackTimers;
 	ComponentContainer<Motion> motions;
-	ComponentContainer<Collision> collisions;
+	ComponentContainer<Rest> rests;
+	ComponentContainer<COLLISION_LAYER> colliders;
 	ComponentContainer<Player> players;
 	ComponentContainer<Mesh *> meshPtrs;
 	ComponentContainer<RenderRequest> renderRequests;
@@ -53,7 +54,6 @@ public:
 	ComponentContainer<HealthBuff> healthBuffs;
 	ComponentContainer<Camera> cameras;
 	ComponentContainer<Door> doors;
-	ComponentContainer<DamageIndicator> damageIndicators;
 	ComponentContainer<TutorialIcon> tutorialIcons;
 	ComponentContainer<EnemyDash> enemyDashes;
 	ComponentContainer<ElevatorButton> elevatorButtons;
@@ -70,6 +70,12 @@ public:
 	ComponentContainer<Sigil> sigils;
 	ComponentContainer<Spike> spikes;
 	ComponentContainer<Landlord> landlords;
+	ComponentContainer<Chaser> chasers;
+	ComponentContainer<Dasher> dashers;
+	ComponentContainer<Homing> homings;
+
+	// Collisions found by the physics system this frame, not a component container (never holds removed entities past a frame)
+	std::vector<CollisionPair> collisions;
 
 	// constructor that adds all containers for looping over them
 	// IMPORTANT: Don't forget to add any newly added containers!
@@ -80,7 +86,8 @@ public:
 		registry_list.push_back(&blockedTimers);
 		registry_list.push_back(&attackTimers);
 		registry_list.push_back(&motions);
-		registry_list.push_back(&collisions);
+		registry_list.push_back(&rests);
+		registry_list.push_back(&colliders);
 		registry_list.push_back(&players);
 		registry_list.push_back(&meshPtrs);
 		registry_list.push_back(&renderRequests);
@@ -118,7 +125,6 @@ public:
 		registry_list.push_back(&healthBuffs);
 		registry_list.push_back(&cameras);
 		registry_list.push_back(&doors);
-		registry_list.push_back(&damageIndicators);
 		registry_list.push_back(&tutorialIcons);
 		registry_list.push_back(&enemyDashes);
 		registry_list.push_back(&elevatorButtons);
@@ -135,6 +141,9 @@ public:
 		registry_list.push_back(&sigils);
 		registry_list.push_back(&spikes);
 		registry_list.push_back(&landlords);
+		registry_list.push_back(&chasers);
+		registry_list.push_back(&dashers);
+		registry_list.push_back(&homings);
 	}
 
 	void clear_all_components()
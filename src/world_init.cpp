@@ -1,10 +1,20 @@
 #include "world_init.hpp"
 #include "world_system.hpp"
 #include "tiny_ecs_registry.hpp"
+#include "solid_grid.hpp"
+#include "animation_system.hpp"
 
 #include <iostream>
 #include <random>
 
+// Walls, furniture and triggers never move, they go in the solid grid instead of the pairwise collision loop
+// Their motion has to be final by the time this is called
+static void insertStaticCollider(Entity entity, COLLISION_LAYER layer)
+{
+	registry.colliders.insert(entity, layer);
+	solid_grid.insert(entity, registry.motions.get(entity), layer);
+}
+
 Entity createPlayer(RenderSystem *renderer, vec2 pos)
 {
 	auto entity = Entity();
@@ -19,6 +29,7 @@ Entity createPlayer(RenderSystem *renderer, vec2 pos)
 	motion.scale = vec2({PLAYER_BB_WIDTH, PLAYER_BB_HEIGHT});
 
 	Player &player = registry.players.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::PLAYER);
 	player.dash_cooldown_ms = 250.f;
 	registry.renderRequests.insert(
 		entity,
@@ -93,17 +104,8 @@ Entity createPlayer(RenderSystem *renderer, vec2 pos)
 		die_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[run_s.name] = run_s;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[run_b.name] = run_b;
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[idle_s.name] = idle_s;
-	animSet.animations[idle_b.name] = idle_b;
-	animSet.animations[attack_f.name] = attack_f;
-	animSet.animations[attack_b.name] = attack_b;
-	animSet.animations[attack_s.name] = attack_s;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.add_set({run_s, run_f, run_b, idle_f, idle_s, idle_b, attack_f, attack_b, attack_s, die});
+	animation_library.play(animSet, idle_f.name);
 
 	// Add damage to player
 	Damage &damage = registry.damages.emplace(entity);
@@ -196,15 +198,7 @@ Entity createHPBar(RenderSystem *renderer, vec2 pos)
 		empty_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[full.name] = full;
-	animSet.animations[seven.name] = seven;
-	animSet.animations[six.name] = six;
-	animSet.animations[five.name] = five;
-	animSet.animations[four.name] = four;
-	animSet.animations[three.name] = three;
-	animSet.animations[two.name] = two;
-	animSet.animations[one.name] = one;
-	animSet.animations[empty.name] = empty;
+	animSet.clip_set = animation_library.add_set({full, seven, six, five, four, three, two, one, empty});
 
 	return entity;
 }
@@ -257,6 +251,7 @@ Entity createBossEnemy(RenderSystem *renderer, vec2 position)
 
 	// Create an (empty) Bug component to be able to refer to all bug
 	auto &enemy = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	enemy.enemy_type = ENEMY_TYPES::FINAL_BOSS;
 
 	auto &health = registry.healths.emplace(entity);
@@ -277,49 +272,9 @@ Entity createBossEnemy(RenderSystem *renderer, vec2 position)
 		 GEOMETRY_BUFFER_ID::SPRITE,
 		 0});
 
-	std::vector<int> idle_f_vec = {0, 1, 2, 3, 4, 5, 6};
-	Animation idle_f = {
-		"final_boss_enemy_idle_f",
-		12,
-		SPRITE_ASSET_ID::FINAL_BOSS,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {10, 11, 12, 13, 14, 15};
-	Animation run_f = {
-		"final_boss_enemy_run_f",
-		10,
-		SPRITE_ASSET_ID::FINAL_BOSS,
-		run_f_vec};
-
-	std::vector<int> die_vec = {38, 39, 40, 41, 42, 43, 44, 45, 46};
-	Animation die = {
-		"final_boss_enemy_die",
-		10,
-		SPRITE_ASSET_ID::FINAL_BOSS,
-		die_vec};
-
-
-	std::vector<int> attack_f_vec = {0, 1, 2, 3, 4, 5, 6, 7};
-	Animation attack_f = {
-		"final_boss_enemy_attack_f",
-		10,
-		SPRITE_ASSET_ID::FINAL_BOSS_ATTACK,
-		attack_f_vec};
-
-	std::vector<int> landlord_vec = {48};
-	Animation landlord = {
-		"final_boss_landlord",	
-		10,
-		SPRITE_ASSET_ID::FINAL_BOSS,
-		landlord_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.animations[attack_f.name] = attack_f;
-	animSet.animations[landlord.name] = landlord;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::FINAL_BOSS);
+	animation_library.play(animSet, ENEMY_TYPES::FINAL_BOSS, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -344,7 +299,9 @@ Entity createContactSlow(RenderSystem *renderer, vec2 position)
 
 	// Create an (empty) Bug component to be able to refer to all bug
 	Deadly &deadly = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	deadly.enemy_type = ENEMY_TYPES::CONTACT_DMG;
+	registry.chasers.emplace(entity);
 	registry.healths.emplace(entity);
 	registry.damages.emplace(entity);
 	registry.renderRequests.insert(
@@ -356,31 +313,9 @@ Entity createContactSlow(RenderSystem *renderer, vec2 position)
 		 1,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {0, 1, 2, 3, 4, 5};
-	Animation idle_f = {
-		"slowenemy_idle_f",
-		15,
-		SPRITE_ASSET_ID::SKELETON,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {18, 19, 20, 21, 22, 23};
-	Animation run_f = {
-		"slowenemy_run_f",
-		10,
-		SPRITE_ASSET_ID::SKELETON,
-		run_f_vec};
-	std::vector<int> die_vec = {36, 37, 38, 39, 39};
-	Animation die = {
-		"slowenemy_die",
-		7,
-		SPRITE_ASSET_ID::PLAYER,
-		die_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::CONTACT_DMG);
+	animation_library.play(animSet, ENEMY_TYPES::CONTACT_DMG, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -404,7 +339,9 @@ Entity createContactFast(RenderSystem *renderer, vec2 position)
 
 	// create an empty Eel component to be able to refer to all eels
 	Deadly &deadly = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	deadly.enemy_type = ENEMY_TYPES::CONTACT_DMG_2;
+	registry.chasers.emplace(entity);
 	registry.healths.emplace(entity);
 	auto &damage = registry.damages.emplace(entity);
 	// TODO: adjust	 damage amounts
@@ -418,32 +355,9 @@ Entity createContactFast(RenderSystem *renderer, vec2 position)
 		 1,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {0, 1};
-	Animation idle_f = {
-		"fastenemy_idle_f",
-		2,
-		SPRITE_ASSET_ID::SLIME,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {10, 11, 12, 13, 14};
-	Animation run_f = {
-		"fastenemy_run_f",
-		8,
-		SPRITE_ASSET_ID::SLIME,
-		run_f_vec};
-
-	std::vector<int> die_vec = {1, 2, 3, 4, 4};
-	Animation die = {
-		"fastenemy_die",
-		7,
-		SPRITE_ASSET_ID::SLIME,
-		die_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::CONTACT_DMG_2);
+	animation_library.play(animSet, ENEMY_TYPES::CONTACT_DMG_2, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -468,7 +382,9 @@ Entity createRangedEnemy(RenderSystem *renderer, vec2 position)
 
 	// Create an (empty) Bug component to be able to refer to all bug
 	auto &enemy = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	enemy.enemy_type = ENEMY_TYPES::RANGED;
+	registry.chasers.emplace(entity);
 	registry.healths.emplace(entity);
 	registry.damages.emplace(entity);
 	registry.ranged.emplace(entity);
@@ -481,32 +397,9 @@ Entity createRangedEnemy(RenderSystem *renderer, vec2 position)
 		 0,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {0, 1, 2, 3, 4};
-	Animation idle_f = {
-		"rangedenemy_idle_f",
-		12,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {8, 9, 10, 11, 12, 13, 14, 15};
-	Animation run_f = {
-		"rangedenemy_run_f",
-		10,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		run_f_vec};
-
-	std::vector<int> die_vec = {32, 33, 34, 35, 36};
-	Animation die = {
-		"rangedenemy_die",
-		7,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		die_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::RANGED);
+	animation_library.play(animSet, ENEMY_TYPES::RANGED, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -537,6 +430,7 @@ Entity createRangedProjectile(RenderSystem *renderer, vec2 position)
 	auto &health = registry.healths.emplace(entity);
 	health.hit_points = 1.f;
 	registry.projectiles.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::PROJECTILE);
 	registry.renderRequests.insert(
 		entity,
 		{TEXTURE_ASSET_ID::RANGED_PROJECTILE,
@@ -569,7 +463,9 @@ Entity createRangedHomingEnemy(RenderSystem *renderer, vec2 position)
 
 	// Create an (empty) Bug component to be able to refer to all bug
 	auto &enemy = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	enemy.enemy_type = ENEMY_TYPES::RANGED_HOMING;
+	registry.chasers.emplace(entity);
 	registry.healths.emplace(entity);
 	registry.damages.emplace(entity);
 	registry.ranged.emplace(entity);
@@ -582,32 +478,9 @@ Entity createRangedHomingEnemy(RenderSystem *renderer, vec2 position)
 		 0,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {0, 1};
-	Animation idle_f = {
-		"rangedenemy_idle_f",
-		5,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {6, 7, 8, 9};
-	Animation run_f = {
-		"rangedenemy_run_f",
-		9,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		run_f_vec};
-
-	std::vector<int> die_vec = {12, 13, 14, 15, 16, 17};
-	Animation die = {
-		"rangedenemy_die",
-		7,
-		SPRITE_ASSET_ID::RANGED_ENEMY,
-		die_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::RANGED_HOMING);
+	animation_library.play(animSet, ENEMY_TYPES::RANGED_HOMING, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -633,11 +506,13 @@ Entity createRangedHomingProjectile(RenderSystem *renderer, vec2 position)
 	// Create an (empty) Bug component to be able to refer to all bug
 	auto &enemy = registry.deadlys.emplace(entity);
 	enemy.enemy_type = ENEMY_TYPES::HOMING_PROJECTILE;
+	registry.homings.emplace(entity);
 	auto &damage = registry.damages.emplace(entity);
 	damage.damage = 25.f;
 	auto &health = registry.healths.emplace(entity);
 	health.hit_points = 1.f;
 	registry.projectiles.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::PROJECTILE);
 	registry.renderRequests.insert(
 		entity,
 		{TEXTURE_ASSET_ID::HOMING_PROJECTILE,
@@ -669,7 +544,9 @@ Entity createSlowingEnemy(RenderSystem *renderer, vec2 position)
 
 	// create an empty Eel component to be able to refer to all eels
 	Deadly &deadly = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	deadly.enemy_type = ENEMY_TYPES::SLOWING_CONTACT;
+	registry.chasers.emplace(entity);
 	registry.healths.emplace(entity);
 	auto &damage = registry.damages.emplace(entity);
 	// TODO: adjust	 damage amounts
@@ -686,32 +563,9 @@ Entity createSlowingEnemy(RenderSystem *renderer, vec2 position)
 		 1,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {0, 1};
-	Animation idle_f = {
-		"fastenemy_idle_f",
-		2,
-		SPRITE_ASSET_ID::SLOWING_ENEMY,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {4, 5, 6, 7};
-	Animation run_f = {
-		"fastenemy_run_f",
-		13,
-		SPRITE_ASSET_ID::SLOWING_ENEMY,
-		run_f_vec};
-
-	std::vector<int> die_vec = {8, 9, 10};
-	Animation die = {
-		"fastenemy_die",
-		5,
-		SPRITE_ASSET_ID::SLOWING_ENEMY,
-		die_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::SLOWING_CONTACT);
+	animation_library.play(animSet, ENEMY_TYPES::SLOWING_CONTACT, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -735,8 +589,10 @@ Entity createDashingEnemy(RenderSystem *renderer, vec2 position)
 	motion.scale = vec2({24, 24});
 
 	Deadly &deadly = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	deadly.enemy_type = ENEMY_TYPES::DASHING;
 	registry.enemyDashes.emplace(entity);
+	registry.dashers.emplace(entity);
 	registry.healths.emplace(entity);
 	registry.damages.emplace(entity);
 	registry.renderRequests.insert(
@@ -748,39 +604,9 @@ Entity createDashingEnemy(RenderSystem *renderer, vec2 position)
 		 1,
 		 RENDER_LAYER::CREATURES});
 
-	std::vector<int> idle_f_vec = {7, 8, 9, 10};
-	Animation idle_f = {
-		"slowenemy_idle_f",
-		2,
-		SPRITE_ASSET_ID::DASHING_ENEMY,
-		idle_f_vec};
-
-	std::vector<int> run_f_vec = {7, 8, 9, 10};
-	Animation run_f = {
-		"slowenemy_run_f",
-		13,
-		SPRITE_ASSET_ID::DASHING_ENEMY,
-		run_f_vec};
-	std::vector<int> die_vec = {14, 15, 16, 17, 18, 19, 20};
-	Animation die = {
-		"slowenemy_die",
-		7,
-		SPRITE_ASSET_ID::DASHING_ENEMY,
-		die_vec};
-
-	std::vector<int> dash_vec = {21};
-	Animation dash = {
-		"slowenemy_dash",
-		7,
-		SPRITE_ASSET_ID::DASHING_ENEMY,
-		dash_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[die.name] = die;
-	animSet.animations[dash.name] = dash;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::DASHING);
+	animation_library.play(animSet, ENEMY_TYPES::DASHING, ENEMY_CLIP::IDLE_F);
 
 	return entity;
 }
@@ -831,25 +657,24 @@ Entity createBasicAttackHitbox(RenderSystem *renderer, vec2 position, Entity pla
 		d_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[up.name] = up;
-	animSet.animations[down.name] = down;
-	animSet.animations[side.name] = side;
+	animSet.clip_set = animation_library.add_set({up, down, side});
 
 	if (player.attack_direction == vec2{0, -1})
 	{
-		animSet.current_animation = up.name;
+		animation_library.play(animSet, up.name);
 	}
 	else if (player.attack_direction == vec2{0, 1})
 	{
-		animSet.current_animation = down.name;
+		animation_library.play(animSet, down.name);
 	}
 	else
 	{
-		animSet.current_animation = side.name;
+		animation_library.play(animSet, side.name);
 		motion.scale.x *= player.attack_direction.x;
 	}
 
 	registry.playerAttacks.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ATTACK);
 
 	return entity;
 }
@@ -1155,6 +980,7 @@ Entity createWalls(RenderSystem *renderer, vec2 pos, std::vector<std::vector<int
 
 	// Add wall to solid objects - player can't move through walls
 	registry.solidObjs.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::SOLID);
 
 	return entity;
 }
@@ -1315,6 +1141,7 @@ Entity createFurniture(RenderSystem *renderer, vec2 pos, int type)
 
 	// create an empty component for the furniture as a solid object
 	registry.solidObjs.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::SOLID);
 	registry.renderRequests.insert(
 		entity, {texture,
 				 SPRITE_ASSET_ID::SPRITE_COUNT,
@@ -1341,6 +1168,7 @@ Entity createSlimePatch(RenderSystem *renderer, vec2 pos)
 	motion.scale.y *= -1;
 
 	registry.stickies.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::TRIGGER);
 	registry.renderRequests.insert(
 		entity, {TEXTURE_ASSET_ID::TEXTURE_COUNT,
 				 SPRITE_ASSET_ID::SPRITE_COUNT,
@@ -1389,9 +1217,8 @@ Entity createExperience(RenderSystem *renderer, vec2 pos, int experience)
 		collect_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.animations[collect.name] = collect;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle, collect});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -1550,9 +1377,8 @@ Entity createStaminaBar(RenderSystem *renderer, vec2 pos)
 		depleting_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[full.name] = full;
-	animSet.animations[depleting.name] = depleting;
-	animSet.current_animation = full.name;
+	animSet.clip_set = animation_library.add_set({full, depleting});
+	animation_library.play(animSet, full.name);
 
 	return entity;
 }
@@ -1612,6 +1438,7 @@ Entity createSwarmMember(RenderSystem *renderer, vec2 pos, float separation, flo
 	registry.meshPtrs.emplace(entity, &mesh);
 
 	Deadly &deadly = registry.deadlys.emplace(entity);
+	registry.colliders.insert(entity, COLLISION_LAYER::ENEMY);
 	deadly.enemy_type = ENEMY_TYPES::SWARM;
 	Health &health = registry.healths.emplace(entity);
 	health.hit_points = 50.f;
@@ -1634,17 +1461,9 @@ Entity createSwarmMember(RenderSystem *renderer, vec2 pos, float separation, flo
 		 GEOMETRY_BUFFER_ID::SPRITE,
 		 1});
 
-	std::vector<int> idle_vec = {0, 1};
-	Animation idle = {
-		"swarmenemy_idle_f",
-		10,
-		SPRITE_ASSET_ID::BEETLE,
-		idle_vec};
-
 	auto &animSet = registry.animationSets.emplace(entity);
-
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.enemy_set(ENEMY_TYPES::SWARM);
+	animation_library.play(animSet, ENEMY_TYPES::SWARM, ENEMY_CLIP::IDLE_F);
 
 	int lead_boid = (leader == -1) ? entity : leader;
 
@@ -1761,6 +1580,7 @@ Entity createTempPowerup(RenderSystem *renderer, vec2 pos, PowerupType type, flo
 	motion.scale = vec2(48, 48);
 
 	registry.eatables.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::TRIGGER);
 
 	Powerup &powerup = registry.powerups.emplace(entity);
 
@@ -1816,6 +1636,7 @@ Entity createHealthBuff(RenderSystem *renderer, vec2 pos)
 
 	registry.healthBuffs.emplace(entity);
 	registry.holdInteracts.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::TRIGGER);
 	
 
 	// create an empty component for the furniture as a solid object
@@ -1834,8 +1655,8 @@ Entity createHealthBuff(RenderSystem *renderer, vec2 pos)
 		idle_f_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle_f.name] = idle_f;
-	animSet.current_animation = idle_f.name;
+	animSet.clip_set = animation_library.add_set({idle_f});
+	animation_library.play(animSet, idle_f.name);
 
 	return entity;
 }
@@ -1866,6 +1687,7 @@ Entity createDoor(RenderSystem *renderer, vec2 pos)
 	motion.scale = vec2(150, 150);
 
 	registry.doors.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::TRIGGER);
 
 	registry.renderRequests.insert(
 		entity, {TEXTURE_ASSET_ID::DOOR,
@@ -2032,23 +1854,6 @@ Entity createExitButton(RenderSystem *renderer, vec2 pos)
 	return entity;
 }
 
-Entity createDamageIndicator(RenderSystem *renderer, int damage, vec2 pos, float rng, float multiplier)
-{
-	auto entity = Entity();
-
-	Motion &motion = registry.motions.emplace(entity);
-	motion.position = pos;
-	motion.velocity = {0.f, 0.f};
-	motion.scale = vec2(32, 32);
-
-	auto &indicator = registry.damageIndicators.emplace(entity);
-	indicator.damage = damage;
-	indicator.rng = rng;
-	indicator.multiplier = multiplier;
-
-	return entity;
-}
-
 Entity createFloor(RenderSystem *renderer)
 {
 	auto entity = Entity();
@@ -2104,8 +1909,8 @@ Entity createMovementKeys(RenderSystem *renderer, vec2 pos)
 		idle_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -2141,8 +1946,8 @@ Entity createDashKey(RenderSystem *renderer, vec2 pos)
 		idle_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -2178,8 +1983,8 @@ Entity createInteractKey(RenderSystem *renderer, vec2 pos)
 		idle_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -2241,8 +2046,8 @@ Entity createPauseKey(RenderSystem *renderer, vec2 pos)
 		idle_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -2278,8 +2083,8 @@ Entity createTutorialToggleKey(RenderSystem *renderer, vec2 pos)
 		idle_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[idle.name] = idle;
-	animSet.current_animation = idle.name;
+	animSet.clip_set = animation_library.add_set({idle});
+	animation_library.play(animSet, idle.name);
 
 	return entity;
 }
@@ -2366,12 +2171,9 @@ Entity createTenant(RenderSystem *renderer, vec2 pos, int level)
 		idle_f_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[run_s.name] = run_s;
-	animSet.animations[run_f.name] = run_f;
-	animSet.animations[run_b.name] = run_b;
-	animSet.animations[idle_f.name] = idle_f;
+	animSet.clip_set = animation_library.add_set({run_s, run_f, run_b, idle_f});
 
-	animSet.current_animation = idle_f.name;
+	animation_library.play(animSet, idle_f.name);
 
 	return entity;
 }
@@ -2477,15 +2279,9 @@ Entity createElevatorDisplay(RenderSystem *renderer, vec2 pos)
 		locked_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[empty.name] = empty;
-	animSet.animations[level_1.name] = level_1;
-	animSet.animations[level_2.name] = level_2;
-	animSet.animations[level_3.name] = level_3;
-	animSet.animations[level_4.name] = level_4;
-	animSet.animations[level_5.name] = level_5;
-	animSet.animations[locked.name] = locked;
+	animSet.clip_set = animation_library.add_set({empty, level_1, level_2, level_3, level_4, level_5, locked});
 
-	animSet.current_animation = empty.name;
+	animation_library.play(animSet, empty.name);
 
 	return entity;
 }
@@ -2521,8 +2317,8 @@ Entity createProgressCircle(RenderSystem *renderer, vec2 pos, Entity connect)
 		progress_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[progress.name] = progress;
-	animSet.current_animation = progress.name;
+	animSet.clip_set = animation_library.add_set({progress});
+	animation_library.play(animSet, progress.name);
 
 	return entity;
 }
@@ -2549,6 +2345,7 @@ Entity createSigil(RenderSystem *renderer, vec2 pos) {
 
 	registry.sigils.emplace(entity);
 	registry.holdInteracts.emplace(entity);
+	insertStaticCollider(entity, COLLISION_LAYER::TRIGGER);
 
 	return entity;
 }
@@ -2592,9 +2389,8 @@ Entity createSpikes(RenderSystem *renderer, vec2 pos) {
 			attack_vec};
 
 	auto &animSet = registry.animationSets.emplace(entity);
-	animSet.animations[follow.name] = follow;
-	animSet.animations[attack.name] = attack;
-	animSet.current_animation = follow.name;
+	animSet.clip_set = animation_library.add_set({follow, attack});
+	animation_library.play(animSet, follow.name);
 
 	return entity;
 }
\ No newline at end of file
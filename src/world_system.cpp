@@ -12,6 +12,15 @@
 // mac config: run  brew install nlohmann-json
 
 #include "physics_system.hpp"
+#include "raycast_system.hpp"
+#include "solid_grid.hpp"
+#include "frame_arena.hpp"
+#include "tile_query.hpp"
+#include "debug_draw.hpp"
+#include "damage_indicator_system.hpp"
+#include "path_pool.hpp"
+#include "ai_lod.hpp"
+#include "audio_system.hpp"
 #include "animation_system.hpp"
 #include "player_controller.hpp"
 #include <iomanip>
@@ -26,9 +35,9 @@ const size_t RANGED_ENEMY_SPAWN_DELAY_MS = 5000 * 3;
 const size_t RANGED_ENEMY_PROJECTILE_DELAY_MS = 3000;
 const size_t DASHING_ENEMY_SPAWN_DELAY_MS = 5000 * 3;
 
-const int TILE_SIZE = 100;
+// enemies never spawn closer than this to the player
+const float ENEMY_SPAWN_MIN_DISTANCE = 300.f;
 std::vector<vec2> tile_vec;
-std::vector<vec2> spawnable_tiles;
 const int LIGHT_FLICKER_RATE = 2000 * 10;
 const int FPS_COUNTER_MS = 1000;
 const float POWERUP_DROP_CHANCE = 0.35;
@@ -52,6 +61,10 @@ int num_enemies = 0;
 
 int map_counter = 1;
 
+// state and level the renderer's texture preload set was last picked for
+GameState preloaded_state = START;
+int preloaded_level = -1;
+
 std::vector<int> current_door_pos;
 
 
@@ -192,28 +205,12 @@ WorldSystem::WorldSystem()
 
 WorldSystem::~WorldSystem()
 {
+	// the audio thread frees the decoded sounds, which has to happen before the mixer closes
+	audio.shutdown();
 
 	// destroy music components
 	if (background_music != nullptr)
 		Mix_FreeMusic(background_music);
-	if (button_click_sound != nullptr)
-		Mix_FreeChunk(button_click_sound);
-	if (salmon_eat_sound != nullptr)
-		Mix_FreeChunk(salmon_eat_sound);
-	if (player_damage_sound != nullptr)
-		Mix_FreeChunk(player_damage_sound);
-	if (enemy_damage_sound != nullptr)
-		Mix_FreeChunk(enemy_damage_sound);
-	if (level_up_sound != nullptr)
-		Mix_FreeChunk(level_up_sound);
-	if (door_sound != nullptr)
-		Mix_FreeChunk(door_sound);
-	if (summon_sound != nullptr)
-		Mix_FreeChunk(summon_sound);
-	if (exp_sound != nullptr)
-		Mix_FreeChunk(exp_sound);
-	if (level_up_load_sound != nullptr)
-		Mix_FreeChunk(level_up_load_sound);
 
 	Mix_CloseAudio();
 
@@ -310,22 +307,23 @@ GLFWwindow *WorldSystem::create_window()
 	}
 
 	background_music = Mix_LoadMUS(audio_path("bg_music_fighting.wav").c_str());
-	button_click_sound = Mix_LoadWAV(audio_path("click.wav").c_str());
-	salmon_eat_sound = Mix_LoadWAV(audio_path("eat_sound.wav").c_str());
-	player_damage_sound = Mix_LoadWAV(audio_path("damage.wav").c_str());
-	enemy_damage_sound = Mix_LoadWAV(audio_path("enemy_damage.wav").c_str());
-	level_up_sound = Mix_LoadWAV(audio_path("level_up_select.wav").c_str());
-	door_sound = Mix_LoadWAV(audio_path("door.wav").c_str());
-	summon_sound = Mix_LoadWAV(audio_path("summon.wav").c_str());
-	exp_sound = Mix_LoadWAV(audio_path("exp.wav").c_str());
-	level_up_load_sound = Mix_LoadWAV(audio_path("level_up.wav").c_str());
-
-	if (background_music == nullptr || button_click_sound == nullptr || salmon_eat_sound == nullptr || player_damage_sound == nullptr || enemy_damage_sound == nullptr || level_up_sound == nullptr || summon_sound == nullptr)
-	{
-		fprintf(stderr, "Failed to load sounds\n %s\n %s\n %s\n make sure the data directory is present",
-				audio_path("music.wav").c_str(),
-				audio_path("death_sound.wav").c_str(),
-				audio_path("eat_sound.wav").c_str());
+
+	// sound effects are played from the audio thread, loud feedback about the player wins a busy mixer over hit and pickup spam
+	audio.configure(SOUND_ASSET_ID::PLAYER_DAMAGE, 2, 3);
+	audio.configure(SOUND_ASSET_ID::LEVEL_UP_LOAD, 1, 2);
+	audio.configure(SOUND_ASSET_ID::LEVEL_UP, 1, 2);
+	audio.configure(SOUND_ASSET_ID::DOOR, 1, 2);
+	audio.configure(SOUND_ASSET_ID::SUMMON, 2, 2);
+	audio.configure(SOUND_ASSET_ID::BUTTON_CLICK, 2, 1);
+	audio.configure(SOUND_ASSET_ID::SALMON_EAT, 3, 1);
+	audio.configure(SOUND_ASSET_ID::ENEMY_DAMAGE, 3, 0);
+	audio.configure(SOUND_ASSET_ID::EXP, 3, 0);
+
+	if (background_music == nullptr || !audio.init(audio_path("sounds.bank")))
+	{
+		fprintf(stderr, "Failed to load sounds\n %s\n %s\n make sure the data directory is present",
+				audio_path("bg_music_fighting.wav").c_str(),
+				audio_path("sounds.bank").c_str());
 		return nullptr;
 	}
 
@@ -404,33 +402,61 @@ void WorldSystem::init(RenderSystem *renderer_arg)
 	restart_world();
 }
 
-// Create an HP bar for an enemy
-void createHPBar(Entity enemy)
+// Bounding boxes, solid grid cells, enemy paths and line of sight, only what is near the camera
+void WorldSystem::draw_debug_overlay()
 {
-	// Check to avoid errors since collisions occur after world step
+	const vec3 BOX_COLOR = {0.8f, 0.1f, 0.1f};
+	const vec3 CELL_COLOR = {0.2f, 0.4f, 1.f};
+	const vec3 PATH_COLOR = {1.f, 1.f, 0.f};
+	const vec3 LOS_CLEAR_COLOR = {0.f, 1.f, 0.f};
+	const vec3 LOS_BLOCKED_COLOR = {1.f, 0.f, 0.f};
 
-	if (registry.swarms.has(enemy))
+	vec2 camera_position = registry.motions.get(camera).position;
+	vec2 view_half = {window_width_px / 2.f, window_height_px / 2.f};
+	auto near_camera = [&](vec2 pos, vec2 half)
 	{
-		return;
+		return abs(pos.x - camera_position.x) <= view_half.x + half.x && abs(pos.y - camera_position.y) <= view_half.y + half.y;
+	};
+
+	for (Entity entity : registry.motions.entities)
+	{
+		Motion &motion = registry.motions.get(entity);
+		if (registry.userInterfaces.has(entity) || !near_camera(motion.position, abs(motion.scale) / 2.f))
+		{
+			continue;
+		}
+		debug_draw.box(motion.position, motion.scale, BOX_COLOR);
 	}
-	if (registry.healths.has(enemy) && !registry.projectiles.has(enemy))
+
+	// broad phase: which grid cells hold solids and how many
+	solid_grid.for_each_cell([&](vec2 cell_min, vec2 cell_max, size_t count)
 	{
-		float &hp = registry.healths.get(enemy).hit_points;
-		float &max_hp = registry.healths.get(enemy).max_hp;
-		Motion &enemy_motion = registry.motions.get(enemy);
-		// Shift centre of line to left as the hp bar decreases
-		Entity hp_bar = createLine({enemy_motion.position.x - ((100.f) * (1 - (hp / max_hp))) / 2,
-									enemy_motion.position.y - abs(enemy_motion.scale.y) * 0.75f},
-								   {(100.f) * hp / max_hp, 10.f});
-		vec3 &color = registry.colors.emplace(hp_bar);
-		if (registry.bosses.has(enemy))
+		vec2 centre = (cell_min + cell_max) / 2.f;
+		if (!near_camera(centre, (cell_max - cell_min) / 2.f))
 		{
-			color = vec3(1.f, 0.f, 0.f);
+			return;
 		}
-		else
+		debug_draw.box(centre, cell_max - cell_min, CELL_COLOR);
+		debug_draw.text(cell_min + vec2(5.f, 20.f), std::to_string(count), CELL_COLOR);
+	});
+
+	for (Entity entity : registry.paths.entities)
+	{
+		const Path &path = registry.paths.get(entity);
+		debug_draw.path(path_pool.data(path.points), path_pool.size(path.points), PATH_COLOR);
+	}
+
+	Entity player = registry.players.entities[0];
+	vec2 player_pos = registry.motions.get(player).position;
+	for (Entity entity : registry.deadlys.entities)
+	{
+		vec2 enemy_pos = registry.motions.get(entity).position;
+		if (!near_camera(enemy_pos, {0.f, 0.f}))
 		{
-			color = vec3(0.f, 5.f, 0.f);
+			continue;
 		}
+		bool visible = raycaster.has_los(enemy_pos, player_pos);
+		debug_draw.line(enemy_pos, player_pos, visible ? LOS_CLEAR_COLOR : LOS_BLOCKED_COLOR);
 	}
 }
 
@@ -472,7 +498,7 @@ void WorldSystem::update_stamina_bar()
 	AnimationSet &stamina_anim = registry.animationSets.get(stamina_bar);
 
 	if (player.is_attacking) {
-		stamina_anim.current_animation = "staminabar_depleting";
+		animation_library.play(stamina_anim, "staminabar_depleting");
 	}
 }
 
@@ -675,6 +701,13 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 	assert(registry.screenStates.components.size() <= 1);
 	ScreenState &screen = registry.screenStates.components[0];
 
+	if (screen.state != preloaded_state || map_counter != preloaded_level)
+	{
+		renderer->preloadTextures(screen.state, map_counter);
+		preloaded_state = screen.state;
+		preloaded_level = map_counter;
+	}
+
 	if (screen.state == GameState::START)
 	{
 		glfwSetWindowTitle(window, "Eviction of the Damned");
@@ -715,7 +748,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				else
 				{
 					AnimationSet& animSet = registry.animationSets.get(e);
-					animSet.current_animation = "elevator_empty";
+					animation_library.play(animSet, "elevator_empty");
 					display.selection_made = false;
 				}
 			}
@@ -726,6 +759,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 	// Remove debug info from the last step
 	while (registry.debugComponents.entities.size() > 0)
 		registry.remove_all_components_of(registry.debugComponents.entities.back());
+	debug_draw.clear();
 
 
 	// Updating window title with points
@@ -751,6 +785,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 	cameraMotion.position = player_pos;
 
 	vec2 player_pos_map = vec2((int)((player_pos.x - world_origin.x) - ((int)(player_pos.x - world_origin.x) % TILE_SIZE)) / TILE_SIZE, (int)((player_pos.y - world_origin.y) - ((int)(player_pos.y - world_origin.y) % TILE_SIZE)) / TILE_SIZE);
+	tile_query.set_focus(player_pos);
 
 
 	// Update particle emitters; (particles still move in cutscenes)
@@ -758,15 +793,13 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		ParticleEmitter &emitter = registry.emitters.get(entity);
 		emitter.time_elapsed_ms += elapsed_ms_since_last_update;
 
-		std::vector<Particle> survivors;
-		for (auto it = emitter.particles.begin(); it != emitter.particles.end(); it++) {
-			Particle& particle = *it;
+		// drop expired particles in place, keeps the emitter's storage instead of reallocating it every frame
+		for (Particle &particle : emitter.particles) {
 			particle.time_elapsed_ms += elapsed_ms_since_last_update;
-			if (particle.time_elapsed_ms < particle.lifespan_ms) {
-				survivors.push_back(particle);
-			}
 		}
-		emitter.particles = survivors;
+		emitter.particles.erase(std::remove_if(emitter.particles.begin(), emitter.particles.end(), [](const Particle &particle) {
+			return particle.time_elapsed_ms >= particle.lifespan_ms;
+		}), emitter.particles.end());
 
 		if (emitter.particles.size() == 0 && emitter.emitted_count >= emitter.particle_count) {
 			registry.remove_all_components_of(entity);
@@ -787,54 +820,19 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		bool tenant = true;
 		if (registry.tenants.entities.size() == 0)
 		{
-			// need to find a tile off screen where the tenant can spawn - use BFS
-			bool spawn_tile_found = false;
-			vec2 current_tenant_pos = {-1, -1};
-			std::vector<vec2> tiles_checked;
-			std::vector<vec2> tile_queue;
-			tile_queue.push_back(player_pos_map);
-
-			while (!spawn_tile_found) {
-				if (tile_queue.size() == 0) {
-					// Obviously not permanent error handling. just for now
-					std::cout << "Error: tile not found for tenant" << std::endl;
-					exit(1);
-				}
-
-				std::vector<vec2> new_queue;
-				for (vec2 tile : tile_queue) {
-					if ((tile.x < 0) || (tile.y < 0) || (tile.x >= current_map[0].size()) || tile.y >= current_map.size()) {
-						continue;
-					}
-					if (std::find(tiles_checked.begin(), tiles_checked.end(), tile) != tiles_checked.end()) {
-						continue;
-					}
-
-					if (current_map[tile.y][tile.x] == 1) {
-						// Tile is spawnable - check distance from player
-						if ((abs(tile.y - player_pos_map.y) > 6) && (abs(tile.x - player_pos_map.x) > 8)) {
-							// Tile is not visible - tenant can be spawned
-							spawn_tile_found = true;
-							current_tenant_pos = tile;
-							break;
-						}
-					}
-					
-					for (int i = -1; i <= 1; i++) {
-						for (int j = -1; j <=1; j++) {
-							if ((i == 0) && (j == 0)) {
-								continue;
-							}
-							new_queue.push_back({tile.x + i, tile.y + j});
-						}
-					}
-					tiles_checked.push_back(tile);
-				}
-				tile_queue.clear();
-				tile_queue = new_queue;
+			// need to find the closest floor tile off screen where the tenant can spawn
+			ivec2 player_tile = ivec2(player_pos_map);
+			ivec2 current_tenant_pos;
+			bool spawn_tile_found = tile_query.nearest_tile(player_tile, [&](ivec2 tile, int value) {
+				// Tile is not visible - tenant can be spawned
+				return value == 1 && (abs(tile.y - player_tile.y) > 6) && (abs(tile.x - player_tile.x) > 8);
+			}, current_tenant_pos);
+			if (!spawn_tile_found) {
+				// Obviously not permanent error handling. just for now
+				std::cout << "Error: tile not found for tenant" << std::endl;
+				exit(1);
 			}
 
-
 			vec2 world_pos = {(640 - (25 * 100)) + (current_tenant_pos[0] * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (current_tenant_pos[1] * TILE_SIZE) + (TILE_SIZE / 2)};
 			std::cout << "tenant spawned in at " << current_tenant_pos.x << " " << current_tenant_pos.y << std::endl;
 			// varying tenant based on map
@@ -910,6 +908,21 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			frames = 0;
 		}
 		createText({1000.f, 650.f}, 1.f, "FPS: " + std::to_string(fps), glm::vec3(1.0f, 0.f, 0.f));
+
+		// sprites drawn / culled last frame
+		const RenderSystem::DrawStats &draw_stats = renderer->getDrawStats();
+		createText({1000.f, 610.f}, 0.6f, "Drawn: " + std::to_string(draw_stats.drawn) + " Culled: " + std::to_string(draw_stats.culled), glm::vec3(1.0f, 0.f, 0.f));
+
+		// scratch memory the last frame took from the frame arena instead of the heap
+		const FrameArena::Stats &arena_stats = frame_arena.last_frame();
+		createText({1000.f, 580.f}, 0.6f, "Arena: " + std::to_string(arena_stats.bytes / 1024) + "KB in " + std::to_string(arena_stats.allocations) + " allocs", glm::vec3(1.0f, 0.f, 0.f));
+
+		// texture memory resident against the budget
+		const TextureCache &texture_cache = renderer->getTextureCache();
+		createText({1000.f, 550.f}, 0.6f, "Textures: " + std::to_string(texture_cache.resident_bytes() / (1024 * 1024)) + "/" + std::to_string(texture_cache.get_budget() / (1024 * 1024)) + "MB, " + std::to_string(texture_cache.resident_count()) + " resident", glm::vec3(1.0f, 0.f, 0.f));
+
+		// enemies per AI tier last step and how many of them actually ran their AI
+		createText({1000.f, 520.f}, 0.6f, "AI: " + std::to_string(ai_lod.count(AI_TIER::ON_SCREEN)) + " on screen, " + std::to_string(ai_lod.count(AI_TIER::NEAR)) + " near, " + std::to_string(ai_lod.count(AI_TIER::FAR)) + " far, " + std::to_string(ai_lod.updated()) + " updated", glm::vec3(1.0f, 0.f, 0.f));
 	}
 
 	if (registry.doors.components.size() == 0 && goal_reached)
@@ -919,23 +932,22 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		createDoor(renderer, world_pos);
 	}
 
-	for (int i = (int)motions_registry.components.size() - 1; i >= 0; --i)
+	// only solids stream out, walk those instead of every motion (back to front, removing one fills its slot from the end)
+	for (int i = (int)registry.solidObjs.size() - 1; i >= 0; --i)
 	{
-		Motion &motion = motions_registry.components[i];
-		Entity entity = motions_registry.entities[i];
+		Entity entity = registry.solidObjs.entities[i];
+		Motion &motion = motions_registry.get(entity);
 
-		if (registry.solidObjs.has(entity))
+		if ((abs(player_pos.x - motion.position.x) > 800) || (abs(player_pos.y - motion.position.y) > 800))
 		{
-			if ((abs(player_pos.x - motion.position.x) > 800) || (abs(player_pos.y - motion.position.y) > 800))
-			{
-				vec2 obj_pos = motion.position;
-				vec2 obj_pos_map = vec2((int)((obj_pos.x - world_origin.x) - ((int)abs(obj_pos.x - world_origin.x) % TILE_SIZE)) / TILE_SIZE, (int)((obj_pos.y - world_origin.y) - ((int)abs(obj_pos.y - world_origin.y) % TILE_SIZE)) / TILE_SIZE);
+			vec2 obj_pos = motion.position;
+			vec2 obj_pos_map = vec2((int)((obj_pos.x - world_origin.x) - ((int)abs(obj_pos.x - world_origin.x) % TILE_SIZE)) / TILE_SIZE, (int)((obj_pos.y - world_origin.y) - ((int)abs(obj_pos.y - world_origin.y) % TILE_SIZE)) / TILE_SIZE);
 
-				if (std::find(tile_vec.begin(), tile_vec.end(), vec2(obj_pos_map.x, obj_pos_map.y)) != tile_vec.end())
-				{
-					tile_vec.erase(std::find(tile_vec.begin(), tile_vec.end(), vec2(obj_pos_map.x, obj_pos_map.y)));
-					registry.remove_all_components_of(entity);
-				}
+			if (std::find(tile_vec.begin(), tile_vec.end(), vec2(obj_pos_map.x, obj_pos_map.y)) != tile_vec.end())
+			{
+				tile_vec.erase(std::find(tile_vec.begin(), tile_vec.end(), vec2(obj_pos_map.x, obj_pos_map.y)));
+				solid_grid.remove(entity);
+				registry.remove_all_components_of(entity);
 			}
 		}
 	}
@@ -1134,12 +1146,6 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		}
 	}
 
-	// create hp bars for enemies
-	for (auto &enemy : registry.deadlys.entities)
-	{
-		createHPBar(enemy);
-	}
-
 	// update unlocked levels - easier to do in step function than miss something small
 	Player &player = registry.players.components[0];
 	player.levels_unlocked = levels_unlocked;
@@ -1150,38 +1156,21 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		// TODO: spawn frequencies and spawn radius to be adjusted
 		//  Spawn Level 1 type enemy: slow with contact damage
 		next_contact_slow_spawn -= elapsed_ms_since_last_update * current_speed;
-		if (next_contact_slow_spawn < 0.f && num_enemies < enemy_spawn_cap)
+		vec2 contact_slow_pos;
+		if (next_contact_slow_spawn < 0.f && num_enemies < enemy_spawn_cap && tile_query.random_tile_outside(ENEMY_SPAWN_MIN_DISTANCE, contact_slow_pos))
 		{
 			next_contact_slow_spawn = (CONTACT_SLOW_SPAWN_DELAY_MS / 2) + uniform_dist(rng) * (CONTACT_SLOW_SPAWN_DELAY_MS / 2);
-			vec2 contact_slow_pos;
-			float distance_to_player;
-			float index;
-			do
-			{
-				index = static_cast<int>(uniform_dist(rng) * spawnable_tiles.size());
-				contact_slow_pos = {(640 - (25 * 100)) + (spawnable_tiles[index].y * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (spawnable_tiles[index].x * TILE_SIZE) + (TILE_SIZE / 2)};
-				distance_to_player = sqrt(pow(contact_slow_pos.x - player_pos.x, 2) + pow(contact_slow_pos.y - player_pos.y, 2));
-			} while (distance_to_player < 300.f);
 
 			createContactSlow(renderer, contact_slow_pos);
 			num_enemies++;
-			// tile_vec.push_back(spawnable_tiles[index]);
 		}
 
 		// Spawn Level 2 type enemy: fast with contact damage
 		next_contact_fast_spawn -= elapsed_ms_since_last_update * current_speed;
-		if (next_contact_fast_spawn < 0.f && num_enemies < enemy_spawn_cap)
+		vec2 contact_fast_pos;
+		if (next_contact_fast_spawn < 0.f && num_enemies < enemy_spawn_cap && tile_query.random_tile_outside(ENEMY_SPAWN_MIN_DISTANCE, contact_fast_pos))
 		{
 			next_contact_fast_spawn = (CONTACT_FAST_SPAWN_DELAY_MS / 2) + uniform_dist(rng) * (CONTACT_FAST_SPAWN_DELAY_MS / 2);
-			vec2 contact_fast_pos;
-			float distance_to_player;
-			float index;
-			do
-			{
-				index = static_cast<int>(uniform_dist(rng) * spawnable_tiles.size());
-				contact_fast_pos = {(640 - (25 * 100)) + (spawnable_tiles[index].y * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (spawnable_tiles[index].x * TILE_SIZE) + (TILE_SIZE / 2)};
-				distance_to_player = sqrt(pow(contact_fast_pos.x - player_pos.x, 2) + pow(contact_fast_pos.y - player_pos.y, 2));
-			} while (distance_to_player < 300.f);
 
 			//Introduce slowing enemy from level 2 onwards
 			if (map_counter >= 2) {
@@ -1198,24 +1187,14 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				createContactFast(renderer, contact_fast_pos);
 			}
 			num_enemies++;
-
-			// tile_vec.push_back(spawnable_tiles[index]);
 		}
 
 		// Spawn Level 3 type enemy: slow ranged enemy
 		next_ranged_spawn -= elapsed_ms_since_last_update * current_speed;
-		if (next_ranged_spawn < 0.f && num_enemies < enemy_spawn_cap)
+		vec2 ranged_pos;
+		if (next_ranged_spawn < 0.f && num_enemies < enemy_spawn_cap && tile_query.random_tile_outside(ENEMY_SPAWN_MIN_DISTANCE, ranged_pos))
 		{
 			next_ranged_spawn = (RANGED_ENEMY_SPAWN_DELAY_MS / 2) + uniform_dist(rng) * (RANGED_ENEMY_SPAWN_DELAY_MS / 2);
-			vec2 ranged_pos;
-			float distance_to_player;
-			float index;
-			do
-			{
-				index = static_cast<int>(uniform_dist(rng) * spawnable_tiles.size());
-				ranged_pos = {(640 - (25 * 100)) + (spawnable_tiles[index].y * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (spawnable_tiles[index].x * TILE_SIZE) + (TILE_SIZE / 2)};
-				distance_to_player = sqrt(pow(ranged_pos.x - player_pos.x, 2) + pow(ranged_pos.y - player_pos.y, 2));
-			} while (distance_to_player < 300.f);
 			
 			//Introduce ranged homing enemy from level 3 onwards
 			if (map_counter >= 3) {
@@ -1232,29 +1211,18 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				createRangedEnemy(renderer, ranged_pos);
 			}
 			num_enemies++;
-			
-			// tile_vec.push_back(spawnable_tiles[index]);
 		}
 
 		//Introduce dashing enemy from level 4 onwards
 		if (map_counter >= 4) {
 			// Spawn dashing enemy
 			next_dashing_spawn -= elapsed_ms_since_last_update * current_speed;
-			if (next_dashing_spawn < 0.f && num_enemies < enemy_spawn_cap)
+			vec2 dashing_pos;
+			if (next_dashing_spawn < 0.f && num_enemies < enemy_spawn_cap && tile_query.random_tile_outside(ENEMY_SPAWN_MIN_DISTANCE, dashing_pos))
 			{
 				next_dashing_spawn = (DASHING_ENEMY_SPAWN_DELAY_MS / 2) + uniform_dist(rng) * (DASHING_ENEMY_SPAWN_DELAY_MS / 2);
-				vec2 dashing_pos;
-				float distance_to_player;
-				float index;
-				do
-				{
-					index = static_cast<int>(uniform_dist(rng) * spawnable_tiles.size());
-					dashing_pos = { (640 - (25 * 100)) + (spawnable_tiles[index].y * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + (spawnable_tiles[index].x * TILE_SIZE) + (TILE_SIZE / 2) };
-					distance_to_player = sqrt(pow(dashing_pos.x - player_pos.x, 2) + pow(dashing_pos.y - player_pos.y, 2));
-				} while (distance_to_player < 300.f);
 				createDashingEnemy(renderer, dashing_pos);
 				num_enemies++;
-				// tile_vec.push_back(spawnable_tiles[index]);
 			}
 		}
 	}
@@ -1309,7 +1277,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 					vec2 map_pos = vec2((int)((world_pos.x - world_origin.x) - ((int)abs(world_pos.x - world_origin.x) % TILE_SIZE)) / TILE_SIZE, (int)((world_pos.y - world_origin.y) - ((int)abs(world_pos.y - world_origin.y) % TILE_SIZE)) / TILE_SIZE);
 
 					int tiles = 0;
-					std::vector<vec2> tileselect = {
+					vec2 tileselect[8] = {
 						{map_pos.x + 1, map_pos.y},
 						{map_pos.x - 1, map_pos.y},
 						{map_pos.x, map_pos.y + 2},
@@ -1368,7 +1336,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 					s.attack = true;
 					registry.deathTimers.insert(spike, {s.attack_length});
 
-					spike_anim.current_animation = "spike_attack";
+					animation_library.play(spike_anim, "spike_attack");
 				}
 			}
 		}
@@ -1376,10 +1344,21 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 
 
 	// Spawn projectiles for ranged enemies
+	// test every ranged enemy against the player in one batch
+	std::vector<vec2> ranged_positions;
+	ranged_positions.reserve(registry.ranged.size());
 	for (auto &ranged : registry.ranged.entities)
 	{
+		ranged_positions.push_back(registry.motions.get(ranged).position);
+	}
+	std::vector<bool> ranged_los;
+	raycaster.has_los_batch(ranged_positions, player_pos, ranged_los);
+
+	for (size_t i = 0; i < registry.ranged.entities.size(); i++)
+	{
+		Entity ranged = registry.ranged.entities[i];
 		// Don't shoot if there's no los
-		if (physics.has_los(registry.motions.get(ranged).position, player_pos))
+		if (ranged_los[i])
 		{
 			float &projectile_delay = registry.ranged.get(ranged).projectile_delay;
 			projectile_delay -= elapsed_ms_since_last_update * current_speed;
@@ -1567,7 +1546,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			player.curr_dash_cooldown_ms = player.dash_cooldown_ms;
 			registry.motions.get(my_player).speed = min(registry.motions.get(my_player).speed, 300.f);
 			player.is_dash_up = true;
-			stamina_anim.current_animation = "staminabar_full";
+			animation_library.play(stamina_anim, "staminabar_full");
 
 		} // Player done dashing
 		else if (player.curr_dash_cooldown_ms < (player.dash_cooldown_ms - player.dash_time))
@@ -1576,11 +1555,11 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			registry.motions.get(my_player).velocity = {0, 0};
 			registry.lightUps.remove(my_player);
 
-			stamina_anim.current_animation = "staminabar_full";
+			animation_library.play(stamina_anim, "staminabar_full");
 		} // Player dashing
 		else
 		{
-			stamina_anim.current_animation = "staminabar_depleting";
+			animation_library.play(stamina_anim, "staminabar_depleting");
 
 			if (!tutorial.dash)
 			{
@@ -1608,7 +1587,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			}
 		}
 	} else if (!player.is_attacking) {
-		stamina_anim.current_animation = "staminabar_full";
+		animation_library.play(stamina_anim, "staminabar_full");
 	}
 
 	player_controller.step(elapsed_ms_since_last_update);
@@ -1653,46 +1632,18 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			continue;
 		}
 
-		AnimationSet &animSet_enemy = registry.animationSets.get(e);
-		std::string enemy_name = "";
-		switch (enemy.enemy_type)
+		// projectiles don't animate, every other type's clips were interned when the animation library was built
+		if (enemy.enemy_type == ENEMY_TYPES::PROJECTILE || enemy.enemy_type == ENEMY_TYPES::HOMING_PROJECTILE)
 		{
-		case ENEMY_TYPES::PROJECTILE:
 			continue;
-		case ENEMY_TYPES::HOMING_PROJECTILE:
-			continue;
-		case ENEMY_TYPES::RANGED:
-			enemy_name = "ranged";
-			break;
-		case ENEMY_TYPES::CONTACT_DMG:
-			enemy_name = "slow";
-			break;
-		case ENEMY_TYPES::CONTACT_DMG_2:
-			enemy_name = "fast";
-			break;
-		case ENEMY_TYPES::SWARM:
-			enemy_name = "swarm";
-			break;
-		case ENEMY_TYPES::SLOWING_CONTACT:
-			enemy_name = "fast";
-			break;
-		case ENEMY_TYPES::RANGED_HOMING:
-			enemy_name = "ranged";
-			break;
-		case ENEMY_TYPES::FINAL_BOSS:
-			enemy_name = "final_boss_";
-			break;
-		case ENEMY_TYPES::DASHING:
-			enemy_name = "slow";
-			break;
-		default:
-			break;
 		}
+
+		AnimationSet &animSet_enemy = registry.animationSets.get(e);
 		switch (enemy.state)
 		{
 		case ENEMY_STATE::IDLE:
 			std::cout << "idle" << std::endl;
-			animSet_enemy.current_animation = enemy_name + "enemy_idle_f";
+			animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::IDLE_F);
 			break;
 		case ENEMY_STATE::RUN:
 			std::cout << "run" << std::endl;
@@ -1702,20 +1653,20 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				render_rqst.used_sprite = SPRITE_ASSET_ID::FINAL_BOSS;
 			}
 
-			animSet_enemy.current_animation = enemy_name + "enemy_run_f";
+			animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::RUN_F);
 			break;
 		case ENEMY_STATE::DEAD:
 			// seems fine
 			if (registry.bosses.has(e) && registry.bosses.get(e).stage == FinalLevelStage::PLAYER_WIN) {
-				if (animSet_enemy.current_animation != enemy_name + "landlord") {
-					animSet_enemy.current_animation = enemy_name + "landlord";
+				if (!animation_library.is_playing(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::LANDLORD)) {
+					animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::LANDLORD);
 					animSet_enemy.current_frame = 0;
 				}
 				std::cout << "landlord stage" << std::endl;
 			} else {
 				std::cout << "dying" << std::endl;
-				if (animSet_enemy.current_animation != enemy_name + "enemy_die") {
-					animSet_enemy.current_animation = enemy_name + "enemy_die";
+				if (!animation_library.is_playing(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::DIE)) {
+					animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::DIE);
 					animSet_enemy.current_frame = 0;
 				}
 			}
@@ -1729,12 +1680,12 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				auto &render_rqst = registry.renderRequests.get(e);
 				render_rqst.used_sprite = SPRITE_ASSET_ID::FINAL_BOSS_ATTACK;
 
-				animSet_enemy.current_animation = enemy_name + "enemy_attack_f";
+				animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::ATTACK_F);
 			}
 			break;
 		default:
 			std::cout << "default" << std::endl;
-			animSet_enemy.current_animation = enemy_name + "enemy_idle_f";
+			animation_library.play(animSet_enemy, enemy.enemy_type, ENEMY_CLIP::IDLE_F);
 		}
 	}
 
@@ -1796,10 +1747,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 
 	if (debugging.in_debug_mode == true)
 	{
-		for (Motion &motion : motions_registry.components)
-		{
-			createLine(motion.position, motion.scale);
-		}
+		draw_debug_overlay();
 	}
 
 	
@@ -1936,6 +1884,8 @@ void WorldSystem::restart_game()
 	// All that have a motion, we could also iterate over all fish, eels, ... but that would be more cumbersome
 	while (registry.motions.entities.size() > 0)
 		registry.remove_all_components_of(registry.motions.entities.back());
+	// the solids went with their motions, empty the grid before the new level's slime patches go in
+	solid_grid.clear();
 
 
 	// Start up game music
@@ -1944,12 +1894,9 @@ void WorldSystem::restart_game()
 	// Mix_VolumeMusic (5.f);
 	
 
-	// clear spawnable_tiles on map switch
-	spawnable_tiles.clear();
-
 	createFloor(renderer);
 
-	// create a slime patches and create spawnable tiles vector
+	// create slime patches
 	for (int i = 0; i < current_map.size(); i++)
 	{
 		for (int j = 0; j < current_map[0].size(); j++)
@@ -1962,14 +1909,18 @@ void WorldSystem::restart_game()
 				createSlimePatch(renderer, world_pos);
 				// tile_vec.push_back(vec2(i, j));
 			}
-			// create vector of spawnable tiles
-			else if (current_map[i][j] == 1 || (current_map[i][j] >= 3 && current_map[i][j] <= 8))
-			{
-				spawnable_tiles.push_back(vec2(i, j));
-			}
 		}
 	}
 
+	// spawn and placement queries for the new map
+	tile_query.build(current_map);
+
+	// decode the combat sounds while the level starts instead of on the first hit, the rest decode when first played
+	audio.prefetch(SOUND_ASSET_ID::PLAYER_DAMAGE);
+	audio.prefetch(SOUND_ASSET_ID::ENEMY_DAMAGE);
+	audio.prefetch(SOUND_ASSET_ID::EXP);
+	audio.prefetch(SOUND_ASSET_ID::SALMON_EAT);
+
 	// Create final boss 
 	for (int i = 0; i < current_map.size(); i++)
 	{
@@ -2007,6 +1958,10 @@ void WorldSystem::restart_game()
 	lightflicker_counter_ms = 1000;
 	darken_counter_ms = 0;
 	tile_vec.clear();
+	// searches queued on the old map would spend the first frames' budget on enemies that are gone
+	phsyics.path_requests.clear();
+	raycaster.load_map(current_map);
+	damage_numbers.clear();
 
 	// player pos: [25, 44]
 	// player pos on screen: [640, 640]
@@ -2095,161 +2050,174 @@ vec2 norm(vec2 vec)
 // Compute collisions between entities
 void WorldSystem::handle_collisions(float step_seconds)
 {
-	// Loop over all collisions detected by the physics system
-	auto &collisionsRegistry = registry.collisions;
+	// Collisions detected by the physics system, grouped by type so each kind is handled in one contiguous run
+	auto &collisions = registry.collisions;
+	std::stable_sort(collisions.begin(), collisions.end(), [](const CollisionPair &a, const CollisionPair &b)
+					 { return a.type < b.type; });
+
 	bool unstick_player = true;
-	for (uint i = 0; i < collisionsRegistry.components.size(); i++)
+	for (uint i = 0; i < collisions.size(); i++)
 	{
 		// The entity and its collider
-		Entity entity = collisionsRegistry.entities[i];
-		Entity entity_other = collisionsRegistry.components[i].other;
+		Entity entity = collisions[i].first;
+		Entity entity_other = collisions[i].second;
 
-		if (registry.players.has(entity))
+		switch (collisions[i].type)
 		{
-			// Player& player = registry.players.get(entity);
-
-			// Checking Player - Deadly collisions
-			if (registry.deadlys.has(entity_other) || registry.spikes.has(entity_other))
+		// Checking Player - Deadly collisions
+		case COLLISION_TYPE::PLAYER_ENEMY:
+		{
+			float &player_hp = registry.healths.get(entity).hit_points;
+			Player &player = registry.players.get(entity);
+			if (!player.invulnerable && (registry.spikes.has(entity_other) || (registry.deadlys.has(entity_other) && !registry.deathTimers.has(entity_other))))
 			{
+				if (registry.powerups.has(entity))
+				{
+					Powerup &powerup = registry.powerups.get(entity);
+					if (powerup.type == PowerupType::INVINCIBILITY) {
+						if (registry.projectiles.has(entity_other))
+						{
+							registry.remove_all_components_of(entity_other);
+						}
+						// In this case, player does not receive damage
+						continue;
+					}	
+				}
 
-				float &player_hp = registry.healths.get(entity).hit_points;
-				Player &player = registry.players.get(entity);
-				if (!player.invulnerable && (registry.spikes.has(entity_other) || (registry.deadlys.has(entity_other) && !registry.deathTimers.has(entity_other))))
+				if (registry.bosses.has(entity_other) && (registry.bosses.get(entity_other).stage == STAGE1 || registry.bosses.get(entity_other).stage == STAGE2))
 				{
-					if (registry.powerups.has(entity))
-					{
-						Powerup &powerup = registry.powerups.get(entity);
-						if (powerup.type == PowerupType::INVINCIBILITY) {
-							if (registry.projectiles.has(entity_other))
-							{
-								registry.remove_all_components_of(entity_other);
-							}
-							// In this case, player does not receive damage
-							continue;
-						}	
-					}
+					registry.deadlys.get(entity_other).state = ENEMY_STATE::ATTACK;
+					registry.attackTimers.emplace(entity_other);
+				}
 
-					if (registry.bosses.has(entity_other) && (registry.bosses.get(entity_other).stage == STAGE1 || registry.bosses.get(entity_other).stage == STAGE2))
-					{
-						registry.deadlys.get(entity_other).state = ENEMY_STATE::ATTACK;
-						registry.attackTimers.emplace(entity_other);
-					}
+				// player takes damage
+				player_hp -= registry.damages.get(entity_other).damage;
 
-					// player takes damage
-					player_hp -= registry.damages.get(entity_other).damage;
+				// damage sound
+				audio.play(SOUND_ASSET_ID::PLAYER_DAMAGE);
+				// avoid negative hp values for hp bar
+				player_hp = max(0.f, player_hp);
+				// modify hp bar
+				// std::cout << "Player hp: " << player_hp << "\n";
+				if (player_hp <= 200 && player_hp >= 0)
+				{
+					// Motion& motion = registry.motions.get(hp_bar);
+					// motion.scale.x = HPBAR_BB_WIDTH * (player_hp / 100);
+					RenderRequest &hp_bar_render = registry.renderRequests.get(hp_bar);
+					// Total HP bar is 200
+					int hp_level = int(player_hp / 25);
+					// set current animation to hpbar_[hp_level]
+					std::string new_anim = "hpbar_" + std::to_string(hp_level);
+
+					animation_library.play(registry.animationSets.get(hp_bar), new_anim);
+				}
 
-					// damage sound
-					Mix_PlayChannel(-1, player_damage_sound, 0);
-					// avoid negative hp values for hp bar
-					player_hp = max(0.f, player_hp);
-					// modify hp bar
-					// std::cout << "Player hp: " << player_hp << "\n";
-					if (player_hp <= 200 && player_hp >= 0)
+				if (registry.deadlys.has(entity_other)) {
+					if (registry.deadlys.get(entity_other).enemy_type == ENEMY_TYPES::SLOWING_CONTACT)
 					{
-						// Motion& motion = registry.motions.get(hp_bar);
-						// motion.scale.x = HPBAR_BB_WIDTH * (player_hp / 100);
-						RenderRequest &hp_bar_render = registry.renderRequests.get(hp_bar);
-						// Total HP bar is 200
-						int hp_level = int(player_hp / 25);
-						// set current animation to hpbar_[hp_level]
-						std::string new_anim = "hpbar_" + std::to_string(hp_level);
-
-						registry.animationSets.get(hp_bar).current_animation = new_anim;
-					}
-
-					if (registry.deadlys.has(entity_other)) {
-						if (registry.deadlys.get(entity_other).enemy_type == ENEMY_TYPES::SLOWING_CONTACT)
-						{
-							Slows &slows = registry.slows.get(entity_other);
-							player.slowed_amount = slows.speed_dec;
-							player.slowed_duration_ms = slows.duration;
-						}
+						Slows &slows = registry.slows.get(entity_other);
+						player.slowed_amount = slows.speed_dec;
+						player.slowed_duration_ms = slows.duration;
 					}
-					player.invulnerable = true;
-					player.invulnerable_duration_ms = 1000.f;
+				}
+				player.invulnerable = true;
+				player.invulnerable_duration_ms = 1000.f;
 
-					std::vector<Entity> circ_ents = registry.progressCircles.entities;
+				std::vector<Entity> circ_ents = registry.progressCircles.entities;
 
-					// delete any health buff interactions
-					for (Entity e : circ_ents) {
-						ProgressCircle& circ = registry.progressCircles.get(e);
+				// delete any health buff interactions
+				for (Entity e : circ_ents) {
+					ProgressCircle& circ = registry.progressCircles.get(e);
 
-						HoldInteract& interact = registry.holdInteracts.get(circ.connected);
-						interact.interacting = false;
-						interact.touch_time_ms = 0;
-
-						registry.remove_all_components_of(e);
-					}
+					HoldInteract& interact = registry.holdInteracts.get(circ.connected);
+					interact.interacting = false;
+					interact.touch_time_ms = 0;
 
+					registry.remove_all_components_of(e);
 				}
-				if (registry.projectiles.has(entity_other))
-				{
-					registry.remove_all_components_of(entity_other);
-				}
-				if (!registry.deathTimers.has(entity) && player_hp <= 0.f)
-				{
-					registry.deathTimers.emplace(entity);
-					// Mix_PlayChannel(-1, salmon_dead_sound, 0);
 
-					// Control what happens when the player dies here
-					Motion &motion = registry.motions.get(my_player);
-					motion.velocity[0] = 0.0f;
-					motion.velocity[1] = 0.0f;
-				}
-			} 
-			// Checking Player - Eatable collisions (e.g. powerups)
-			else if (registry.eatables.has(entity_other))
+			}
+			if (registry.projectiles.has(entity_other))
 			{
-				if (!registry.deathTimers.has(entity) && !registry.powerups.has(entity))
-				{
-					Powerup &powerup = registry.powerups.get(entity_other);
-					PowerupType type = powerup.type;
-					float timer = POWERUP_TIMER;
-					float multiplier = powerup.multiplier;
+				registry.remove_all_components_of(entity_other);
+			}
+			if (!registry.deathTimers.has(entity) && player_hp <= 0.f)
+			{
+				registry.deathTimers.emplace(entity);
+				// Mix_PlayChannel(-1, salmon_dead_sound, 0);
 
-					registry.remove_all_components_of(entity_other);
+				// Control what happens when the player dies here
+				Motion &motion = registry.motions.get(my_player);
+				motion.velocity[0] = 0.0f;
+				motion.velocity[1] = 0.0f;
+			}
+			break;
+		}
+		// Checking Player - Eatable collisions (e.g. powerups)
+		case COLLISION_TYPE::PLAYER_COLLECTIBLE:
+		{
+			if (!registry.deathTimers.has(entity) && !registry.powerups.has(entity) && registry.powerups.has(entity_other))
+			{
+				Powerup &powerup = registry.powerups.get(entity_other);
+				PowerupType type = powerup.type;
+				float timer = POWERUP_TIMER;
+				float multiplier = powerup.multiplier;
 
-					Powerup &player_powerup = registry.powerups.emplace(entity);
+				registry.remove_all_components_of(entity_other);
 
-					player_powerup.type = type;
+				Powerup &player_powerup = registry.powerups.emplace(entity);
 
-					player_powerup.multiplier = multiplier;
-					player_powerup.timer = timer;
-					player_powerup.equipped = true;
+				player_powerup.type = type;
 
-					Mix_PlayChannel(-1, salmon_eat_sound, 0);
-				}
-			}
-			if (registry.stickies.has(entity_other))
-			{
-				Motion &player_motion = registry.motions.get(my_player);
-				player_motion.speed = 120.f;
-				unstick_player = false;
-			}
+				player_powerup.multiplier = multiplier;
+				player_powerup.timer = timer;
+				player_powerup.equipped = true;
 
-			// touching hold interacts
+				audio.play(SOUND_ASSET_ID::SALMON_EAT);
+			}
+			break;
+		}
+		case COLLISION_TYPE::PLAYER_STICKY:
+		{
+			Motion &player_motion = registry.motions.get(my_player);
+			player_motion.speed = 120.f;
+			unstick_player = false;
+			break;
+		}
+		// touching hold interacts
+		case COLLISION_TYPE::PLAYER_INTERACT:
+		{
 			if (registry.holdInteracts.has(entity_other))
 			{
 				HoldInteract &h = registry.holdInteracts.get(entity_other);
 				h.touching = true;
 			}
-
-
+			break;
+		}
+		case COLLISION_TYPE::PLAYER_DOOR:
+		{
 			if (registry.doors.has(entity_other))
 			{
 				Door &door = registry.doors.get(entity_other);
 				door.touching = true;
 			}
+			break;
 		}
-		else if (registry.deadlys.has(entity))
+		case COLLISION_TYPE::PROJECTILE_SOLID:
 		{
-			if (registry.solidObjs.has(entity_other) && registry.projectiles.has(entity))
+			// may already be gone if it hit the player this frame
+			if (registry.projectiles.has(entity))
 			{
 				registry.remove_all_components_of(entity);
 			}
-		} 
-		else if (registry.playerAttacks.has(entity))
+			break;
+		}
+		case COLLISION_TYPE::ATTACK_ENEMY:
 		{
+			if (!registry.playerAttacks.has(entity))
+			{
+				break;
+			}
 			auto &playerAttacks = registry.playerAttacks.get(entity);
 
 			if (registry.deadlys.has(entity_other) && registry.healths.has(entity_other) && registry.motions.has(entity_other) && !playerAttacks.has_hit)
@@ -2297,7 +2265,7 @@ void WorldSystem::handle_collisions(float step_seconds)
 				player_hp = std::min(player_hp, 200.f);
 				int hp_level = int(player_hp / 25);
 				std::string new_anim = "hpbar_" + std::to_string(hp_level);
-				registry.animationSets.get(hp_bar).current_animation = new_anim;
+				animation_library.play(registry.animationSets.get(hp_bar), new_anim);
 
 
 				// check if entity is final boss and if the boss has taken enough damage to go to next stage
@@ -2310,14 +2278,14 @@ void WorldSystem::handle_collisions(float step_seconds)
 					registry.screenStates.components[0].darken_screen_factor = 0.9;
 
 					// play summon enemies sound
-					Mix_PlayChannel(-1, summon_sound, 0);
+					audio.play(SOUND_ASSET_ID::SUMMON);
 				}
 				if (!registry.projectiles.has(entity_other)) {
-					createDamageIndicator(renderer, damage_dealt, enemy_motion.position, damage_rng, temp_multiplier);
+					damage_numbers.spawn(damage_dealt, enemy_motion.position, damage_rng, temp_multiplier);
 				}
 				
 				// play enemy damage sound
-				Mix_PlayChannel(-1, enemy_damage_sound, 0);
+				audio.play(SOUND_ASSET_ID::ENEMY_DAMAGE);
 
 				vec2 diff = registry.motions.get(entity_other).position - pmotion.position;
 
@@ -2354,6 +2322,10 @@ void WorldSystem::handle_collisions(float step_seconds)
 					death.counter_ms = 550.4f;
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	}
 
@@ -2373,171 +2345,6 @@ void WorldSystem::handle_collisions(float step_seconds)
 	registry.collisions.clear();
 }
 
-vec2 WorldSystem::adjust_knockback_coordinates(int grid_x, int grid_y, int adjust_x, int adjust_y)
-{
-	int x = adjust_x;
-	int y = adjust_y;
-	if (grid_y + y > (int)current_map.size())
-	{
-		y = current_map.size() - grid_y - 1;
-	}
-	else if (grid_y + y < 0)
-	{
-		y = 0;
-	}
-
-	if (grid_x + x > (int)current_map[0].size())
-	{
-		x = current_map[0].size() - grid_x - 1;
-	}
-	else if (grid_x + x < 0)
-	{
-		x = 0;
-	}
-
-	vec2 player_pos = registry.motions.get(my_player).position;
-	do
-	{
-		if (current_map[grid_y + y][grid_x + x] == 1 || (current_map[grid_y + y][grid_x + x] >= 3 && current_map[grid_y + y][grid_x + x] <= 8))
-		{
-			vec2 pos = {(640 - (25 * 100)) + ((grid_x + x) * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + ((grid_y + y) * TILE_SIZE) + (TILE_SIZE / 2)};
-			if (knockback_through_wall_check(vec2(grid_x + x, grid_y + y), player_pos))
-			{
-				return vec2(x, y);
-			}
-		}
-		int temp_x = x;
-		if (temp_x > 0)
-		{
-			temp_x--;
-		}
-		else if (temp_x < 0)
-		{
-			temp_x++;
-		}
-		if (current_map[grid_y + y][grid_x + temp_x] == 1 || (current_map[grid_y + y][grid_x + temp_x] >= 3 && current_map[grid_y + y][grid_x + temp_x] <= 8))
-		{
-			vec2 pos = {(640 - (25 * 100)) + ((grid_x + temp_x) * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + ((grid_y + y) * TILE_SIZE) + (TILE_SIZE / 2)};
-			if (knockback_through_wall_check(vec2(grid_x + temp_x, grid_y + y), player_pos))
-			{
-				return vec2(temp_x, y);
-			}
-		}
-		int temp_y = y;
-		if (temp_y > 0)
-		{
-			temp_y--;
-		}
-		else if (temp_y < 0)
-		{
-			temp_y++;
-		}
-		if (current_map[grid_y + temp_y][grid_x + x] == 1 || (current_map[grid_y + temp_y][grid_x + x] >= 3 && current_map[grid_y + temp_y][grid_x + x] <= 8))
-		{
-			vec2 pos = {(640 - (25 * 100)) + ((grid_x + x) * TILE_SIZE) + (TILE_SIZE / 2), (640 - (44 * 100)) + ((grid_y + temp_y) * TILE_SIZE) + (TILE_SIZE / 2)};
-			if (knockback_through_wall_check(vec2(grid_x + x, grid_y + temp_y), player_pos))
-			{
-				return vec2(x, temp_y);
-			}
-		}
-		if (x > 0)
-		{
-			x--;
-		}
-		else if (x < 0)
-		{
-			x++;
-		}
-		if (y > 0)
-		{
-			y--;
-		}
-		else if (y < 0)
-		{
-			y++;
-		}
-	} while (x != 0 && y != 0);
-
-	return vec2(0, 0);
-}
-
-bool WorldSystem::knockback_through_wall_check(const vec2 &start, const vec2 &end)
-{
-	const float GRID_OFFSET_X = (640 - (25 * TILE_SIZE)) - TILE_SIZE / 2;
-	const float GRID_OFFSET_Y = (640 - (44 * TILE_SIZE)) - TILE_SIZE / 2;
-
-	// Convert to grid coordinates
-	int x2 = static_cast<int>((end.x - GRID_OFFSET_X) / TILE_SIZE);
-	int y2 = static_cast<int>((end.y - GRID_OFFSET_Y) / TILE_SIZE);
-
-	int dx = abs(x2 - start.x);
-	int dy = abs(y2 - start.y);
-	int x = start.x;
-	int y = start.y;
-
-	// Determine step direction
-	int x_step = (start.x < x2) ? 1 : -1;
-	int y_step = (start.y < y2) ? 1 : -1;
-
-	int err;
-
-	// Choose which axis to move along
-	if (dx > dy)
-	{
-		err = dx / 2;
-		while (x != x2)
-		{
-			if (y < 0 || x < 0 || y >= current_map.size() || x >= current_map[0].size())
-			{
-				return false;
-			}
-
-			if (!(current_map[y][x] == 1 || (current_map[y][x] >= 3 && current_map[y][x] <= 8)))
-			{
-				return false;
-			}
-
-			err -= dy;
-			if (err < 0)
-			{
-				y += y_step;
-				err += dx;
-			}
-			x += x_step;
-		}
-	}
-	else
-	{
-		err = dy / 2;
-		while (y != y2)
-		{
-			if (y < 0 || x < 0 || y >= current_map.size() || x >= current_map[0].size())
-			{
-				return false;
-			}
-
-			if (!(current_map[y][x] == 1 || (current_map[y][x] >= 3 && current_map[y][x] <= 8)))
-			{
-				return false;
-			}
-
-			err -= dx;
-			if (err < 0)
-			{
-				x += x_step;
-				err += dy;
-			}
-			y += y_step;
-		}
-	}
-
-	if (y < 0 || x < 0 || y >= current_map.size() || x >= current_map[0].size())
-	{
-		return false;
-	}
-	return current_map[y][x] == 1 || (current_map[y][x] >= 3 && current_map[y][x] <= 8);
-}
-
 // Should the game be over ?
 bool WorldSystem::is_over() const
 {
@@ -2690,7 +2497,7 @@ void WorldSystem::on_key(int key, int, int action, int mod)
 			player.is_dash_up = false;
 			registry.lightUps.emplace(my_player);
 			AnimationSet &stamina_anim = registry.animationSets.get(stamina_bar);
-			stamina_anim.current_animation = "staminabar_depleting";
+			animation_library.play(stamina_anim, "staminabar_depleting");
 
 			player.invulnerable = true;
 			player.invulnerable_duration_ms = player.dash_time + 50.f;
@@ -2754,7 +2561,7 @@ void WorldSystem::on_key(int key, int, int action, int mod)
 				Door &door = registry.doors.get(e);
 				if (door.touching)
 				{
-					Mix_PlayChannel(-1, door_sound, 0);
+					audio.play(SOUND_ASSET_ID::DOOR);
 					tutorial.door = true;
 					if (current_map == map4)
 					{
@@ -2973,7 +2780,7 @@ void WorldSystem::heal_player(Entity health_buff) {
 		// set current animation to hpbar_[hp_level]
 		std::string new_anim = "hpbar_" + std::to_string(hp_level);
 
-		registry.animationSets.get(hp_bar).current_animation = new_anim;
+		animation_library.play(registry.animationSets.get(hp_bar), new_anim);
 	}
 
 	createEffect(renderer, {registry.motions.get(health_buff).position.x + 5.f, registry.motions.get(health_buff).position.y - 45.f}, 1200.f, EFFECT_TYPE::HEART);
@@ -3059,7 +2866,7 @@ void WorldSystem::on_mouse_button(int button, int action, int mods)
 		{
 			if (button.hovering)
 			{
-				Mix_PlayChannel(-1, button_click_sound, 0);
+				audio.play(SOUND_ASSET_ID::BUTTON_CLICK);
 				if (button.level == 0)
 				{
 					exit(0);
@@ -3080,12 +2887,12 @@ void WorldSystem::on_mouse_button(int button, int action, int mods)
 
 					if (std::find(levels_unlocked.begin(), levels_unlocked.end(), button.level) == levels_unlocked.end())
 					{
-						registry.animationSets.get(e).current_animation = "elevator_locked";
+						animation_library.play(registry.animationSets.get(e), "elevator_locked");
 						registry.elevatorDisplays.get(e).message = 0;
 					}
 					else
 					{
-						registry.animationSets.get(e).current_animation = "elevator_level" + std::to_string(button.level);
+						animation_library.play(registry.animationSets.get(e), "elevator_level" + std::to_string(button.level));
 						registry.elevatorDisplays.get(e).message = button.level;
 					}
 
@@ -3135,7 +2942,7 @@ void WorldSystem::set_level_up_state(bool state)
 	ScreenState &screen = registry.screenStates.components[0];
 	if (state)
 	{ // TODO: can we change this to pause function ?
-		Mix_PlayChannel(-1, level_up_load_sound, 0);
+		audio.play(SOUND_ASSET_ID::LEVEL_UP_LOAD);
 		screen.darken_screen_factor = 0.0;
 		screen.state = GameState::GAME;
 	}
@@ -37,16 +37,8 @@ public:
 	void handle_collisions(float step_seconds);
 
 	// music references
+	// sound effects live in the sound bank, see audio_system.hpp (Mix_LoadMUS streams music from disk as it plays)
 	Mix_Music *background_music;
-	Mix_Chunk *button_click_sound;
-	Mix_Chunk *salmon_eat_sound;
-	Mix_Chunk *player_damage_sound;
-	Mix_Chunk *enemy_damage_sound;
-	Mix_Chunk *level_up_sound;
-	Mix_Chunk *level_up_load_sound;
-	Mix_Chunk *door_sound;
-	Mix_Chunk *summon_sound;
-	Mix_Chunk *exp_sound;
 
 	struct Tutorial
 	{
@@ -88,6 +80,8 @@ public:
 	void unpause();
 	void set_level_up_state(bool state);
 	void update_experience_bar();
+	// Adds this step's debug view (debug mode only) to the debug draw buffer
+	void draw_debug_overlay();
 	void update_stamina_bar();
 	void save_player_data(const std::string &filename);
 
@@ -142,12 +136,8 @@ private:
 	void restart_game();
 	void restart_world();
 
-	vec2 adjust_knockback_coordinates(int grid_x, int grid_y, int adjust_x, int adjust_y);
-
 	void spawn_nearby_tile(vec2 curr_tile, std::vector<ENEMY_TYPES> &enemy_types);
 
-	bool knockback_through_wall_check(const vec2 &start, const vec2 &end);
-
 	void destroy_sigil(Entity sigil_entity);
 
 	void heal_player(Entity health_buff);
@@ -0,0 +1,175 @@
+// Times a headless stress scene (thousands of animated sprites, particle emitters and swarm members) with the job
+// system running on 1 up to N threads, and prints how the frame time scales
+// Each frame runs like the game loop: the physics step on the main thread, then the scheduled systems
+// Usage: job_system_benchmark [max_threads] [frames]
+
+// the renderer isn't linked, nothing here needs a GL context
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+
+// stlib
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+// internal
+#include "animation_system.hpp"
+#include "damage_indicator_system.hpp"
+#include "frame_arena.hpp"
+#include "job_system.hpp"
+#include "physics_system.hpp"
+#include "tiny_ecs_registry.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+const int MAP_SIZE = 60;
+const int ANIMATED_SPRITES = 40000;
+const int EMITTERS = 2000;
+const int PARTICLES_PER_EMITTER = 60;
+const int SWARMS = 8;
+const int SWARM_MEMBERS = 60;
+
+static std::vector<std::vector<int>> stress_map()
+{
+	// open floor with a wall all around
+	std::vector<std::vector<int>> map(MAP_SIZE, std::vector<int>(MAP_SIZE, 1));
+	for (int i = 0; i < MAP_SIZE; i++)
+	{
+		map[0][i] = map[MAP_SIZE - 1][i] = map[i][0] = map[i][MAP_SIZE - 1] = 0;
+	}
+	return map;
+}
+
+static void spawn_stress_scene()
+{
+	std::mt19937 rng(27);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	vec2 map_centre = tile_centre({MAP_SIZE / 2, MAP_SIZE / 2});
+	auto random_position = [&](float spread)
+	{
+		return map_centre + (vec2(unit(rng), unit(rng)) - 0.5f) * spread * (float)TILE_SIZE;
+	};
+
+	Entity player = Entity();
+	registry.players.emplace(player);
+	Motion &player_motion = registry.motions.emplace(player);
+	player_motion.position = map_centre;
+	player_motion.scale = {60, 80};
+
+	Animation walk = {"walk", 12, SPRITE_ASSET_ID::SPRITE_COUNT, {0, 1, 2, 3, 4, 5, 6, 7}};
+	Animation idle = {"idle", 6, SPRITE_ASSET_ID::SPRITE_COUNT, {8, 9, 10, 11}};
+	int clip_set = animation_library.add_set({walk, idle});
+	for (int i = 0; i < ANIMATED_SPRITES; i++)
+	{
+		Entity entity = Entity();
+		registry.renderRequests.insert(entity, {});
+		AnimationSet &animation_set = registry.animationSets.emplace(entity);
+		animation_set.clip_set = clip_set;
+		animation_library.play(animation_set, (i % 2) ? "walk" : "idle");
+		animation_set.elapsed_time = unit(rng) * 0.1f;
+	}
+
+	for (int i = 0; i < EMITTERS; i++)
+	{
+		Entity entity = Entity();
+		registry.motions.emplace(entity).position = random_position(40.f);
+		ParticleEmitter &emitter = registry.emitters.emplace(entity);
+		emitter.particle_count = PARTICLES_PER_EMITTER;
+		emitter.emitted_count = PARTICLES_PER_EMITTER;
+		for (int j = 0; j < PARTICLES_PER_EMITTER; j++)
+		{
+			Particle particle;
+			particle.time_elapsed_ms = 0.f;
+			particle.lifespan_ms = 1000.f + 1000.f * unit(rng);
+			particle.pos = registry.motions.get(entity).position;
+			particle.dir = normalize(vec2(unit(rng), unit(rng)) - 0.5f);
+			emitter.particles.push_back(particle);
+		}
+	}
+
+	for (int swarm = 0; swarm < SWARMS; swarm++)
+	{
+		vec2 swarm_centre = random_position(30.f);
+		for (int i = 0; i < SWARM_MEMBERS; i++)
+		{
+			Entity entity = Entity();
+			Motion &motion = registry.motions.emplace(entity);
+			motion.position = swarm_centre + (vec2(unit(rng), unit(rng)) - 0.5f) * 100.f;
+			motion.scale = {20, 20};
+			motion.speed = 150.f;
+			registry.swarms.insert(entity, {swarm, 0.05f, 0.05f, 0.005f});
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int max_threads = (argc > 1) ? atoi(argv[1]) : (int)std::max(1u, std::thread::hardware_concurrency());
+	int frames = (argc > 2) ? atoi(argv[2]) : 120;
+	const float elapsed_ms = 1000.f / 60.f;
+
+	PhysicsSystem &physics = phsyics;
+	AnimationSystem animations;
+	DamageIndicatorSystem damages;
+	std::vector<std::vector<int>> map = stress_map();
+	frame_arena.init();
+
+	// same systems the game schedules while playing
+	SystemSchedule systems;
+	systems.add({"animation", {&registry.renderRequests}, {&registry.animationSets, &registry.renderRequests}, false, [&]()
+				 { animations.step(elapsed_ms); }});
+	systems.add({"damage indicators", {}, {}, false, [&]()
+				 { damages.step(elapsed_ms); }});
+	systems.add({"particles", {}, {&registry.emitters}, false, [&]()
+				 { physics.move_particles(elapsed_ms); }});
+	systems.add({"path requests", {&registry.deadlys, &registry.motions}, {&registry.paths}, false, [&]()
+				 { physics.process_path_requests(); }, true});
+	systems.add({"swarms", {&registry.players, &registry.deathTimers}, {&registry.motions, &registry.swarms}, false, [&]()
+				 { physics.move_swarms(elapsed_ms); }});
+	systems.add({"swarm leavers", {}, {}, true, [&]()
+				 { physics.remove_swarm_leavers(); }});
+
+	printf("%d animated sprites, %d emitters x %d particles, %d swarms x %d members, %d frames\n",
+		   ANIMATED_SPRITES, EMITTERS, PARTICLES_PER_EMITTER, SWARMS, SWARM_MEMBERS, frames);
+	printf("%u hardware threads, rows with more threads than that share cores and say nothing about scaling\n",
+		   std::thread::hardware_concurrency());
+	printf("threads   physics ms   systems ms   frame ms   systems speedup\n");
+
+	double single_thread_systems_ms = 0.0;
+	for (int threads = 1; threads <= max_threads; threads++)
+	{
+		jobs.init(threads - 1);
+		spawn_stress_scene();
+
+		double physics_ms = 0.0;
+		double systems_ms = 0.0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			auto start = Clock::now();
+			physics.step(elapsed_ms, map);
+			auto physics_done = Clock::now();
+			jobs.run_systems(systems);
+			auto systems_done = Clock::now();
+
+			physics_ms += std::chrono::duration<double, std::milli>(physics_done - start).count();
+			systems_ms += std::chrono::duration<double, std::milli>(systems_done - physics_done).count();
+			frame_arena.reset();
+		}
+		physics_ms /= frames;
+		systems_ms /= frames;
+		if (threads == 1)
+		{
+			single_thread_systems_ms = systems_ms;
+		}
+
+		printf("%7d   %10.3f   %10.3f   %8.3f   %15.2fx\n", threads, physics_ms, systems_ms, physics_ms + systems_ms,
+			   single_thread_systems_ms / systems_ms);
+
+		registry.clear_all_components();
+		jobs.shutdown();
+	}
+	return 0;
+}
@@ -0,0 +1,153 @@
+// Checks the draw key encoding and radix sort the renderer builds its draw list with, no GL context needed
+// Covers stages drawing in layer order, draws inside a stage keeping their request order whatever GL state they use,
+// and the sort skipping the bytes every key shares
+// Returns non-zero if any check fails
+
+// stlib
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// internal
+#include "render_sort.hpp"
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+static RenderRequest request(EFFECT_ASSET_ID effect, TEXTURE_ASSET_ID texture, GEOMETRY_BUFFER_ID geometry)
+{
+	RenderRequest render_request;
+	render_request.used_effect = effect;
+	render_request.used_texture = texture;
+	render_request.used_geometry = geometry;
+	return render_request;
+}
+
+static void test_stage_order()
+{
+	// the order the old per layer passes drew in
+	RENDER_LAYER layers[] = {RENDER_LAYER::FLOOR, RENDER_LAYER::FLOOR_DECOR, RENDER_LAYER::CREATURES, RENDER_LAYER::OBSTACLES,
+							 RENDER_LAYER::EFFECTS, RENDER_LAYER::DEFAULT_LAYER, RENDER_LAYER::UI_LAYER_1, RENDER_LAYER::UI_LAYER_2};
+	for (size_t i = 1; i < sizeof(layers) / sizeof(layers[0]); i++)
+	{
+		check(world_stage(layers[i - 1]) < world_stage(layers[i]), "world layers are staged in draw order");
+	}
+	check(world_stage(RENDER_LAYER::UI_LAYER_2) < draw_key::SCREEN_SPACE_UI_1, "screen space UI comes after the world");
+	check(draw_key::SCREEN_SPACE_UI_1 < draw_key::SCREEN_SPACE_UI_2, "screen space UI layer 2 is over layer 1");
+
+	// requests created back to front, the later layers first
+	std::vector<uint64_t> keys;
+	RenderRequest render_request = request(EFFECT_ASSET_ID::TEXTURED, TEXTURE_ASSET_ID::TEXTURE_COUNT, GEOMETRY_BUFFER_ID::SPRITE);
+	uint32_t sequence = 0;
+	for (int stage = draw_key::SCREEN_SPACE_UI_2; stage >= 0; stage--)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			keys.push_back(make_draw_key(stage, render_request, sequence++));
+		}
+	}
+	std::vector<uint64_t> scratch;
+	radix_sort_keys(keys, scratch);
+
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		check(draw_key_stage(keys[i]) == (int)(i / 3), "stages draw in order whatever order the requests were made in");
+	}
+}
+
+static void test_sequence_stable()
+{
+	// sprites on one layer stack in request order, the GL state they use must not reorder them
+	std::mt19937 rng(35);
+	std::vector<uint64_t> keys;
+	std::vector<int> stages;
+	const uint32_t count = 5000;
+	for (uint32_t sequence = 0; sequence < count; sequence++)
+	{
+		RenderRequest render_request = request((EFFECT_ASSET_ID)(rng() % effect_count), (TEXTURE_ASSET_ID)(rng() % texture_count),
+											   (GEOMETRY_BUFFER_ID)(rng() % geometry_count));
+		if (rng() % 2)
+		{
+			render_request.used_sprite = (SPRITE_ASSET_ID)(rng() % sprite_count);
+			render_request.sprite_index = 0;
+		}
+		int stage = (int)(rng() % (draw_key::SCREEN_SPACE_UI_2 + 1));
+		stages.push_back(stage);
+		uint64_t key = make_draw_key(stage, render_request, sequence);
+		check(draw_key_stage(key) == stage && draw_key_sequence(key) == sequence, "stage and sequence decode from the key");
+		keys.push_back(key);
+	}
+
+	std::vector<uint64_t> expected = keys;
+	std::sort(expected.begin(), expected.end());
+	std::vector<uint64_t> scratch;
+	radix_sort_keys(keys, scratch);
+	check(keys == expected, "radix sort matches std::sort");
+
+	for (size_t i = 1; i < keys.size(); i++)
+	{
+		bool same_stage = draw_key_stage(keys[i - 1]) == draw_key_stage(keys[i]);
+		check(draw_key_stage(keys[i - 1]) <= draw_key_stage(keys[i]), "stages never go backwards");
+		check(!same_stage || draw_key_sequence(keys[i - 1]) < draw_key_sequence(keys[i]), "draws in a stage keep their request order");
+	}
+	for (uint64_t key : keys)
+	{
+		check(stages[draw_key_sequence(key)] == draw_key_stage(key), "every draw keeps its stage");
+	}
+}
+
+static void test_skipped_passes()
+{
+	std::vector<uint64_t> scratch;
+	RenderRequest render_request = request(EFFECT_ASSET_ID::TEXTURED, TEXTURE_ASSET_ID::TEXTURE_COUNT, GEOMETRY_BUFFER_ID::SPRITE);
+
+	std::vector<uint64_t> single = {make_draw_key(0, render_request, 7)};
+	check(radix_sort_keys(single, scratch) == 0, "a single key needs no pass");
+
+	// same state and stage, sequences below 64 only differ in the third byte (bits 18 to 23)
+	std::vector<uint64_t> keys;
+	for (uint32_t sequence = 64; sequence-- > 0;)
+	{
+		keys.push_back(make_draw_key(2, render_request, sequence));
+	}
+	check(radix_sort_keys(keys, scratch) == 1, "only the byte the sequences differ in is sorted");
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		check(draw_key_sequence(keys[i]) == i, "the one pass sorts the keys");
+	}
+
+	// a second stage adds the top byte
+	keys.clear();
+	for (uint32_t sequence = 64; sequence-- > 0;)
+	{
+		keys.push_back(make_draw_key((sequence % 2) ? 6 : 2, render_request, sequence));
+	}
+	check(radix_sort_keys(keys, scratch) == 2, "stages add the pass on their byte");
+	for (size_t i = 1; i < keys.size(); i++)
+	{
+		check(keys[i - 1] < keys[i], "the two passes sort the keys");
+	}
+
+	// identical keys are left alone
+	keys.assign(100, make_draw_key(3, render_request, 12));
+	check(radix_sort_keys(keys, scratch) == 0, "identical keys skip every pass");
+}
+
+int main()
+{
+	test_stage_order();
+	test_sequence_stable();
+	test_skipped_passes();
+
+	printf("%d failed checks\n", failures);
+	return (failures == 0) ? 0 : 1;
+}
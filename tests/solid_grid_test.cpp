@@ -0,0 +1,195 @@
+// Replays mover / solid setups through move_and_slide twice, once with the solids found by SolidGrid and once with
+// a query scanning every solid object the way it did before the grid, and checks both push the mover out the same way
+// Returns non-zero if any step differs
+
+// stlib
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// internal
+#include "continuous_collision.hpp"
+#include "solid_grid.hpp"
+#include "tiny_ecs_registry.hpp"
+
+struct SolidSetup
+{
+	vec2 position;
+	vec2 scale;
+	COLLISION_LAYER layer;
+};
+
+struct MoverSetup
+{
+	const char *name;
+	std::vector<SolidSetup> solids;
+	vec2 position;
+	vec2 scale;
+	std::vector<vec2> moves;
+	// solid removed from the registry (without telling the grid) halfway through the moves, -1 for none
+	int removed_halfway;
+};
+
+// Solid query visiting every solid object, what sweep_solids scanned before the grid
+struct LinearSolids
+{
+	template <typename Visit>
+	void operator()(vec2, vec2, Visit visit) const
+	{
+		for (Entity solid : registry.solidObjs.entities)
+		{
+			if (registry.colliders.has(solid) && visit(registry.motions.get(solid)))
+			{
+				return;
+			}
+		}
+	}
+};
+
+static std::vector<Entity> spawn_solids(const std::vector<SolidSetup> &solids)
+{
+	std::vector<Entity> entities;
+	for (const SolidSetup &solid : solids)
+	{
+		Entity entity = Entity();
+		Motion &motion = registry.motions.emplace(entity);
+		motion.position = solid.position;
+		motion.scale = solid.scale;
+		if (solid.layer == COLLISION_LAYER::SOLID)
+		{
+			registry.solidObjs.emplace(entity);
+		}
+		registry.colliders.insert(entity, solid.layer);
+		solid_grid.insert(entity, motion, solid.layer);
+		entities.push_back(entity);
+	}
+	return entities;
+}
+
+// Returns the number of steps where the two movers ended up in different places or blocked on different axes
+static int replay(const MoverSetup &setup)
+{
+	std::vector<Entity> solids = spawn_solids(setup.solids);
+
+	Motion grid_mover;
+	grid_mover.position = setup.position;
+	grid_mover.scale = setup.scale;
+	Motion linear_mover = grid_mover;
+
+	int mismatches = 0;
+	for (size_t i = 0; i < setup.moves.size(); i++)
+	{
+		if (setup.removed_halfway >= 0 && i == setup.moves.size() / 2)
+		{
+			registry.remove_all_components_of(solids[setup.removed_halfway]);
+		}
+
+		bvec2 grid_blocked = move_and_slide(grid_mover, setup.moves[i]);
+		bvec2 linear_blocked = move_and_slide(linear_mover, setup.moves[i], LinearSolids());
+
+		// a corner hit on two solids at the same time can pick either one first, both end up against the corner
+		if (grid_blocked != linear_blocked || distance(grid_mover.position, linear_mover.position) > 1e-3f)
+		{
+			printf("%s, step %zu: grid (%f, %f) blocked (%d, %d), linear scan (%f, %f) blocked (%d, %d)\n", setup.name, i,
+				   grid_mover.position.x, grid_mover.position.y, grid_blocked.x, grid_blocked.y,
+				   linear_mover.position.x, linear_mover.position.y, linear_blocked.x, linear_blocked.y);
+			mismatches++;
+		}
+	}
+
+	for (Entity solid : solids)
+	{
+		registry.remove_all_components_of(solid);
+	}
+	solid_grid.clear();
+	return mismatches;
+}
+
+static std::vector<MoverSetup> recorded_setups()
+{
+	const float T = (float)TILE_SIZE;
+	vec2 origin = tile_centre({25, 44});
+	vec2 player = {60.f, 80.f};
+	std::vector<MoverSetup> setups;
+
+	// walking straight into a wall, then along it
+	setups.push_back({"wall", {{origin + vec2(T, 0), vec2(T), COLLISION_LAYER::SOLID}, {origin + vec2(T, T), vec2(T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{20, 0}, {20, 0}, {20, 0}, {20, 30}, {20, 30}, {20, 30}, {20, 30}, {0, -15}}, -1});
+
+	// diagonal into an inside corner
+	setups.push_back({"corner", {{origin + vec2(T, 0), vec2(T), COLLISION_LAYER::SOLID}, {origin + vec2(0, T), vec2(T), COLLISION_LAYER::SOLID}, {origin + vec2(T, T), vec2(T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{15, 15}, {15, 15}, {15, 15}, {15, 15}, {-10, 5}}, -1});
+
+	// furniture bigger than a tile, straddling tile edges, and a flipped (negative scale) one
+	setups.push_back({"furniture", {{origin + vec2(1.5f * T, 0.5f * T), vec2(2.5f * T, 1.3f * T), COLLISION_LAYER::SOLID}, {origin + vec2(-T, 0.5f * T), vec2(-0.8f * T, 0.6f * T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{30, 10}, {30, 10}, {30, 10}, {-40, 0}, {-40, 0}, {-40, 0}, {-40, 0}}, -1});
+
+	// moves longer than a tile, the sweep has to look past the tiles the mover starts and ends in
+	setups.push_back({"fast", {{origin + vec2(2 * T, 0), vec2(T / 4, T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{350, 0}, {-350, 0}, {350, 5}}, -1});
+
+	// starting inside a solid, moves deeper are blocked and moves back out let through
+	setups.push_back({"overlap", {{origin + vec2(50, 0), vec2(T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{5, 0}, {0, 5}, {-20, 0}, {-20, 0}}, -1});
+
+	// triggers never block
+	setups.push_back({"trigger", {{origin + vec2(T, 0), vec2(T), COLLISION_LAYER::TRIGGER}, {origin + vec2(2 * T, 0), vec2(T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{40, 0}, {40, 0}, {40, 0}, {40, 0}, {40, 0}}, -1});
+
+	// left of / above the map, where tile coordinates go negative
+	vec2 outside = tile_centre({-3, -2});
+	setups.push_back({"outside map", {{outside + vec2(T, 0), vec2(T), COLLISION_LAYER::SOLID}, {outside - vec2(0, T), vec2(T), COLLISION_LAYER::SOLID}},
+					  outside, player, {{30, 0}, {30, 0}, {0, -30}, {0, -30}, {-30, -30}}, -1});
+
+	// wall removed from the registry without going through the grid (level reset, menus)
+	setups.push_back({"removed", {{origin + vec2(T, 0), vec2(T), COLLISION_LAYER::SOLID}},
+					  origin, player, {{30, 0}, {30, 0}, {30, 0}, {30, 0}, {30, 0}, {30, 0}}, 0});
+
+	return setups;
+}
+
+// Rooms of random walls and furniture with a mover wandering through them
+static std::vector<MoverSetup> random_setups(int count)
+{
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	const float T = (float)TILE_SIZE;
+	vec2 room = tile_min({20, 40});
+
+	std::vector<MoverSetup> setups;
+	for (int s = 0; s < count; s++)
+	{
+		MoverSetup setup = {"random", {}, room + vec2(4 * T), {40.f + 40.f * unit(rng), 40.f + 60.f * unit(rng)}, {}, -1};
+		int solids = 5 + (int)(unit(rng) * 30);
+		for (int i = 0; i < solids; i++)
+		{
+			vec2 position = room + vec2(unit(rng), unit(rng)) * 8.f * T;
+			vec2 scale = (unit(rng) < 0.5f) ? vec2(T) : vec2(0.3f + 2.f * unit(rng), 0.3f + 2.f * unit(rng)) * T;
+			COLLISION_LAYER layer = (unit(rng) < 0.2f) ? COLLISION_LAYER::TRIGGER : COLLISION_LAYER::SOLID;
+			setup.solids.push_back({position, scale, layer});
+		}
+		for (int i = 0; i < 60; i++)
+		{
+			setup.moves.push_back((vec2(unit(rng), unit(rng)) - 0.5f) * 80.f);
+		}
+		setup.removed_halfway = (unit(rng) < 0.25f) ? 0 : -1;
+		setups.push_back(setup);
+	}
+	return setups;
+}
+
+int main()
+{
+	std::vector<MoverSetup> setups = recorded_setups();
+	std::vector<MoverSetup> random = random_setups(200);
+	setups.insert(setups.end(), random.begin(), random.end());
+
+	int mismatches = 0;
+	for (const MoverSetup &setup : setups)
+	{
+		mismatches += replay(setup);
+	}
+
+	printf("%zu setups, %d mismatched steps\n", setups.size(), mismatches);
+	return (mismatches == 0) ? 0 : 1;
+}
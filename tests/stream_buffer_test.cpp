@@ -0,0 +1,255 @@
+// Runs the StreamBuffer ring against a stub backend standing in for the GPU
+// Covers wrapping around the segments, waiting on a fence the GPU hasn't passed yet and orphaning when a write
+// doesn't fit its segment, and checks no write ever lands in a range the GPU may still be reading
+// Returns non-zero if any check fails
+
+// the GL backend in stream_buffer.cpp needs the gl3w entry points to link, they're never called here
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+
+// stlib
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+// internal
+#include "stream_buffer.hpp"
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+// Keeps the storage in memory and tracks, for every live fence, the ranges written before it that the GPU reads
+// until the fence is waited on
+class StubStreamBackend : public StreamBackend
+{
+public:
+	struct Range
+	{
+		size_t begin;
+		size_t end;
+	};
+
+	void allocate(size_t size) override
+	{
+		// the GPU keeps reading the old storage, nothing in the new one is busy
+		storage.assign(size, 0);
+		allocations.push_back(size);
+		unfenced.clear();
+	}
+
+	void write(size_t offset, const void *data, size_t size) override
+	{
+		check(offset + size <= storage.size(), "write stays inside the storage");
+		for (const auto &fence : fences)
+		{
+			for (const Range &range : fence.second)
+			{
+				if (offset < range.end && range.begin < offset + size)
+				{
+					overwrites++;
+				}
+			}
+		}
+		if (offset + size <= storage.size())
+		{
+			memcpy(&storage[offset], data, size);
+		}
+		unfenced.push_back({offset, offset + size});
+	}
+
+	uintptr_t insert_fence() override
+	{
+		uintptr_t fence = ++last_fence;
+		fences[fence] = unfenced;
+		unfenced.clear();
+		return fence;
+	}
+
+	void wait_fence(uintptr_t fence) override
+	{
+		check(fences.count(fence) > 0, "waits on a live fence");
+		// the stub GPU finishes the moment anything waits on it
+		if (signalled.count(fence) == 0)
+		{
+			stalls++;
+		}
+		waits.push_back(fence);
+		fences.erase(fence);
+	}
+
+	void delete_fence(uintptr_t fence) override
+	{
+		check(fences.count(fence) > 0, "deletes a live fence");
+		fences.erase(fence);
+	}
+
+	GLuint handle() const override { return 1; }
+
+	// GPU passes the fence without anyone waiting on it, its ranges stay marked until the ring waits or deletes it
+	void signal(uintptr_t fence) { signalled[fence] = true; }
+
+	std::vector<uint8_t> storage;
+	std::vector<size_t> allocations;
+	std::vector<Range> unfenced;
+	std::map<uintptr_t, std::vector<Range>> fences;
+	std::map<uintptr_t, bool> signalled;
+	std::vector<uintptr_t> waits;
+	uintptr_t last_fence = 0;
+	int stalls = 0;
+	int overwrites = 0;
+};
+
+static void test_wrap_around()
+{
+	StubStreamBackend backend;
+	StreamBuffer buffer;
+	const size_t segment_size = 256;
+	buffer.init(&backend, segment_size);
+	check(backend.allocations.size() == 1 && backend.allocations[0] == segment_size * StreamBuffer::SEGMENT_COUNT, "allocates every segment up front");
+
+	std::vector<uintptr_t> frame_fences;
+	for (int frame = 0; frame < 10; frame++)
+	{
+		buffer.begin_frame();
+		int segment = buffer.current_segment();
+		check(segment == (frame + 1) % StreamBuffer::SEGMENT_COUNT, "segments are used round robin");
+
+		// a few odd sized writes filling most of the segment
+		uint8_t data[48];
+		memset(data, frame + 1, sizeof(data));
+		size_t sizes[] = {48, 13, 48, 7, 48, 40};
+		for (size_t size : sizes)
+		{
+			size_t offset = buffer.write(data, size, 16);
+			check(offset % 16 == 0, "offsets are aligned");
+			check(offset >= segment * segment_size && offset + size <= (segment + 1) * segment_size, "writes stay inside the frame's segment");
+			check(backend.storage[offset] == frame + 1 && backend.storage[offset + size - 1] == frame + 1, "data is copied to the returned offset");
+		}
+
+		buffer.end_frame();
+		frame_fences.push_back(backend.last_fence);
+		// the GPU keeps up, every frame is done by the time its segment comes back around
+		backend.signal(backend.last_fence);
+	}
+
+	check(buffer.orphan_count() == 0, "writes that fit never orphan");
+	check(backend.stalls == 0, "no stall when the GPU keeps up");
+	check(backend.overwrites == 0, "no write into a range the GPU is reading");
+	// frames 0..6 had their segment reused by frames 3..9
+	check(backend.waits.size() == frame_fences.size() - StreamBuffer::SEGMENT_COUNT, "waits once per reused segment");
+	for (size_t i = 0; i < backend.waits.size(); i++)
+	{
+		check(backend.waits[i] == frame_fences[i], "waits on the fence of the frame that last used the segment");
+	}
+
+	buffer.shutdown();
+	check(backend.fences.empty(), "shutdown deletes the remaining fences");
+}
+
+static void test_unsignalled_fence()
+{
+	StubStreamBackend backend;
+	StreamBuffer buffer;
+	const size_t segment_size = 128;
+	buffer.init(&backend, segment_size);
+
+	uint8_t data[64] = {};
+	for (int frame = 0; frame < StreamBuffer::SEGMENT_COUNT; frame++)
+	{
+		buffer.begin_frame();
+		buffer.write(data, sizeof(data), 4);
+		buffer.end_frame();
+	}
+	check(backend.waits.empty(), "no wait until a segment comes back around");
+
+	// the GPU is still on the first frame when its segment is needed again
+	uintptr_t first_fence = backend.fences.begin()->first;
+	buffer.begin_frame();
+	check(backend.waits.size() == 1 && backend.waits[0] == first_fence, "waits on the oldest frame's fence");
+	check(backend.stalls == 1, "the wait blocks on the unsignalled fence");
+	check(backend.fences.count(first_fence) == 0, "the fence is released after the wait");
+	check(backend.fences.size() == StreamBuffer::SEGMENT_COUNT - 1, "the other frames' fences stay pending");
+
+	// the segment is free now, the rest of the buffer is still being read
+	buffer.write(data, sizeof(data), 4);
+	buffer.write(data, sizeof(data), 4);
+	check(buffer.orphan_count() == 0, "filling the segment exactly doesn't orphan");
+	check(backend.overwrites == 0, "no write into a range the GPU is reading");
+	buffer.end_frame();
+
+	buffer.shutdown();
+	check(backend.fences.empty(), "shutdown deletes the remaining fences");
+}
+
+static void test_orphan_regrowth()
+{
+	StubStreamBackend backend;
+	StreamBuffer buffer;
+	const size_t segment_size = 64;
+	buffer.init(&backend, segment_size);
+
+	uint8_t small[32];
+	memset(small, 1, sizeof(small));
+	for (int frame = 0; frame < StreamBuffer::SEGMENT_COUNT - 1; frame++)
+	{
+		buffer.begin_frame();
+		buffer.write(small, sizeof(small), 16);
+		buffer.end_frame();
+	}
+
+	// this frame's data starts inside the segment but the second write doesn't fit
+	buffer.begin_frame();
+	int segment = buffer.current_segment();
+	buffer.write(small, sizeof(small), 16);
+	uint8_t large[200];
+	for (size_t i = 0; i < sizeof(large); i++)
+	{
+		large[i] = (uint8_t)i;
+	}
+	size_t offset = buffer.write(large, sizeof(large), 16);
+
+	check(buffer.orphan_count() == 1, "a write bigger than the segment orphans once");
+	check(buffer.segment_capacity() == 256, "segments double until the write and its alignment fit");
+	check(backend.allocations.size() == 2 && backend.allocations[1] == 256 * StreamBuffer::SEGMENT_COUNT, "storage is regrown for every segment");
+	check(backend.fences.empty(), "fences on the old storage are dropped");
+	check(buffer.current_segment() == segment, "the frame stays on its segment");
+	check(offset == segment * buffer.segment_capacity(), "the write restarts at the segment start in the new storage");
+	check(memcmp(&backend.storage[offset], large, sizeof(large)) == 0, "data is copied to the returned offset");
+
+	// later writes keep filling the regrown segment
+	size_t next = buffer.write(small, sizeof(small), 16);
+	check(next == offset + 208, "writes after the orphan continue after it");
+	buffer.end_frame();
+
+	// the next frames run on the grown segments without orphaning again
+	for (int frame = 0; frame < 2 * StreamBuffer::SEGMENT_COUNT; frame++)
+	{
+		buffer.begin_frame();
+		buffer.write(large, sizeof(large), 16);
+		buffer.end_frame();
+	}
+	check(buffer.orphan_count() == 1, "the grown segments hold the large writes");
+	check(backend.overwrites == 0, "no write into a range the GPU is reading");
+
+	buffer.shutdown();
+	check(backend.fences.empty(), "shutdown deletes the remaining fences");
+}
+
+int main()
+{
+	test_wrap_around();
+	test_unsignalled_fence();
+	test_orphan_regrowth();
+
+	printf("%d failed checks\n", failures);
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+// Runs the TextureCache residency policy against a fake uploader standing in for the GPU
+// Covers loading on first use, evicting least recently used textures only once they've been cold for COLD_FRAMES,
+// pinned preloads staying resident over budget and preloads being uploaded PRELOADS_PER_FRAME at a time
+// Returns non-zero if any check fails
+
+// the GL uploader in texture_cache.cpp needs gl3w and stb_image to link, neither is called here
+// (stb_image comes in through components.hpp)
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+#define STB_IMAGE_IMPLEMENTATION
+
+// stlib
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// internal
+#include "texture_cache.hpp"
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+// Every texture takes TEXTURE_BYTES, tracks which names hold storage
+class FakeTextureUploader : public TextureUploader
+{
+public:
+	static const size_t TEXTURE_BYTES = 100;
+
+	size_t upload(GLuint texture, const std::string &path) override
+	{
+		check(path == "texture_" + std::to_string(texture - 1), "uploads the texture's own path");
+		check(uploaded[texture] == false, "never uploads a texture that is already resident");
+		uploaded[texture] = true;
+		uploads++;
+		return TEXTURE_BYTES;
+	}
+
+	void release(GLuint texture) override
+	{
+		check(uploaded[texture] == true, "only releases resident textures");
+		uploaded[texture] = false;
+		releases++;
+	}
+
+	std::map<GLuint, bool> uploaded;
+	int uploads = 0;
+	int releases = 0;
+};
+
+struct CacheSetup
+{
+	FakeTextureUploader uploader;
+	GLuint names[texture_count];
+	std::string paths[texture_count];
+	TextureCache cache;
+
+	explicit CacheSetup(size_t budget)
+	{
+		for (int i = 0; i < texture_count; i++)
+		{
+			names[i] = (GLuint)i + 1;
+			paths[i] = "texture_" + std::to_string(i);
+		}
+		cache.init(&uploader, names, paths, budget);
+	}
+};
+
+static const TEXTURE_ASSET_ID A = (TEXTURE_ASSET_ID)0;
+static const TEXTURE_ASSET_ID B = (TEXTURE_ASSET_ID)1;
+static const TEXTURE_ASSET_ID C = (TEXTURE_ASSET_ID)2;
+static const TEXTURE_ASSET_ID D = (TEXTURE_ASSET_ID)3;
+
+static void test_load_on_use()
+{
+	CacheSetup setup(10 * FakeTextureUploader::TEXTURE_BYTES);
+	TextureCache &cache = setup.cache;
+	check(cache.resident_count() == 0 && setup.uploader.uploads == 0, "nothing is uploaded up front");
+
+	check(cache.use(B) == setup.names[(int)B], "use returns the texture's name");
+	check(cache.resident(B) && setup.uploader.uploads == 1, "the first use uploads the texture");
+	check(cache.resident_bytes() == FakeTextureUploader::TEXTURE_BYTES, "resident bytes count the upload");
+
+	cache.use(B);
+	cache.end_frame();
+	cache.use(B);
+	check(setup.uploader.uploads == 1 && cache.get_stats().loads == 1, "later uses don't upload again");
+
+	check(cache.use(TEXTURE_ASSET_ID::TEXTURE_COUNT) == 0, "sprites without a sheet get no texture");
+	check(setup.uploader.uploads == 1, "no upload for TEXTURE_COUNT");
+	check(!cache.resident(A), "textures never used stay unloaded");
+
+	cache.release_all();
+	check(cache.resident_count() == 0 && cache.resident_bytes() == 0 && setup.uploader.releases == 1, "release_all drops everything resident");
+}
+
+static void test_cold_eviction()
+{
+	// room for two textures
+	CacheSetup setup(2 * FakeTextureUploader::TEXTURE_BYTES);
+	TextureCache &cache = setup.cache;
+
+	// A used on frame 0, B on frame 1, C on frame 2, D every frame: over budget from frame 2 on
+	cache.use(A);
+	cache.use(D);
+	cache.end_frame();
+	cache.use(B);
+	cache.use(D);
+	cache.end_frame();
+	cache.use(C);
+	cache.use(D);
+	cache.end_frame();
+	check(cache.resident_count() == 4, "textures used in the last COLD_FRAMES frames stay over budget");
+
+	// frames 3 .. COLD_FRAMES - 1
+	for (uint64_t frame = 3; frame < TextureCache::COLD_FRAMES; frame++)
+	{
+		cache.use(D);
+		cache.end_frame();
+	}
+	check(cache.resident_count() == 4 && setup.uploader.releases == 0, "nothing is evicted before it has been cold for COLD_FRAMES");
+
+	// frame COLD_FRAMES, A has gone cold
+	cache.use(D);
+	cache.end_frame();
+	check(!cache.resident(A) && cache.resident(B) && cache.resident(C) && cache.resident(D), "the least recently used cold texture goes first");
+	check(setup.uploader.releases == 1, "one eviction per texture gone cold");
+
+	cache.use(D);
+	cache.end_frame();
+	check(!cache.resident(B) && cache.resident(C), "the next oldest goes once it is cold");
+
+	// C is cold next frame, but the cache is within budget again
+	for (int frame = 0; frame < 10; frame++)
+	{
+		cache.use(D);
+		cache.end_frame();
+	}
+	check(cache.resident(C) && cache.resident(D), "cold textures stay while within budget");
+	check(cache.resident_bytes() == 2 * FakeTextureUploader::TEXTURE_BYTES, "eviction stops at the budget");
+
+	// an evicted texture comes back on its next use
+	cache.use(A);
+	check(cache.resident(A) && setup.uploader.uploads == 5, "evicted textures reload on use");
+}
+
+static void test_pinned_preloads()
+{
+	// no room at all, only pinning keeps anything resident
+	CacheSetup setup(0);
+	TextureCache &cache = setup.cache;
+
+	cache.set_preload({A, B, C});
+	check(cache.resident_count() == 0, "set_preload only queues the uploads");
+	for (int frame = 0; frame < 3; frame++)
+	{
+		cache.end_frame();
+	}
+	check(cache.resident(A) && cache.resident(B) && cache.resident(C), "every preload is uploaded");
+
+	for (uint64_t frame = 0; frame < 2 * TextureCache::COLD_FRAMES; frame++)
+	{
+		cache.end_frame();
+	}
+	check(cache.resident_count() == 3 && setup.uploader.releases == 0, "pinned preloads survive over budget however long they're unused");
+
+	// a texture used outside the preload set is evicted as usual
+	cache.use(D);
+	for (uint64_t frame = 0; frame <= TextureCache::COLD_FRAMES; frame++)
+	{
+		cache.end_frame();
+	}
+	check(!cache.resident(D) && cache.resident_count() == 3, "unpinned textures are still evicted");
+
+	// a new set unpins the old one, the textures left out go once cold
+	cache.set_preload({B});
+	cache.end_frame();
+	check(cache.resident_count() == 1 && cache.resident(B), "textures dropped from the set are evicted once cold");
+	check(cache.get_stats().preloads == 3, "a preload already resident isn't uploaded again");
+}
+
+static void test_preload_pacing()
+{
+	CacheSetup setup(texture_count * FakeTextureUploader::TEXTURE_BYTES);
+	TextureCache &cache = setup.cache;
+
+	// B is already resident, only the other three are queued
+	cache.use(B);
+	cache.end_frame();
+	cache.set_preload({C, A, B, D, C});
+
+	TEXTURE_ASSET_ID order[] = {C, A, D};
+	for (int frame = 0; frame < 3; frame++)
+	{
+		int loads = cache.get_stats().loads;
+		cache.end_frame();
+		check(cache.get_stats().loads - loads == TextureCache::PRELOADS_PER_FRAME, "PRELOADS_PER_FRAME uploads each frame");
+		check(cache.resident(order[frame]), "preloads are uploaded in the order the set was given in");
+	}
+
+	int loads = cache.get_stats().loads;
+	cache.end_frame();
+	check(cache.get_stats().loads == loads, "nothing left to preload once the set is resident");
+	check(cache.get_stats().preloads == 3, "duplicates and resident textures are skipped");
+
+	// a texture used before its turn loads on use and isn't uploaded again by the queue
+	cache.release_all();
+	cache.set_preload({A, B});
+	cache.use(B);
+	cache.end_frame();
+	cache.end_frame();
+	check(cache.resident(A) && cache.resident(B) && setup.uploader.uploads == 6, "a preload used early is uploaded once");
+}
+
+int main()
+{
+	test_load_on_use();
+	test_cold_eviction();
+	test_pinned_preloads();
+	test_preload_pacing();
+
+	printf("%d failed checks\n", failures);
+	return (failures == 0) ? 0 : 1;
+}